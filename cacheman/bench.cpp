@@ -0,0 +1,313 @@
+#include "cacheman.h"
+
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Microbenchmarks for cacheman's hot paths: Cache::read/write throughput over
+*               associativity, block size, policy and access pattern, trace parsing and the
+*               cost of a miss; results go out as JSON
+*    Question : CS2610 A6
+*    Build    : build.sh, linked against libcacheman.a
+-------------------------------------------------------------------------------------------------*/
+
+// Access patterns benchmarked, C_GEN_* values up to this one
+#define B_PATTERNS   (C_GEN_ZIPF + 1)
+
+// Defaults
+#define B_ACCESSES  (1 << 18)   //accesses per run (--accesses)
+#define B_REPEAT    3           //runs per benchmark, the fastest is kept (--repeat)
+#define B_CACHE     16384       //cache size (words)
+#define B_FOOTPRINT (1 << 20)   //words spanned by the strided, random and zipf patterns
+#define B_STRIDE    64          //words between strided accesses
+#define B_WRITES    30          //percent of accesses that write
+
+static const char* patternNames[B_PATTERNS] = {"sequential", "strided", "random", "zipf"};
+
+//names by C_CRP_* value
+static const char* policyNames[4] = {"random", "lru", "tree", "xorshift"};
+
+//one benchmark result
+typedef struct Resultst
+{
+    std::string  name;
+    unsigned long long  ops = 0;    //accesses, records or misses timed
+    double  seconds = 0;            //fastest run
+    double  missRatio = -1;         //-1: not applicable
+    double  nsPerMiss = -1;
+    double  bytesPerSecond = -1;
+}  Result;
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//fills <accesses> with <count> accesses of the given C_GEN_* pattern, the same on every run
+static void makePattern(int pattern, uint count, std::vector<Access>& accesses)
+{
+    GeneratorConfig config;
+    config.pattern = pattern;
+    config.length = count;
+    config.footprint = B_FOOTPRINT;
+    config.stride = (pattern == C_GEN_ZIPF) ? 16 : B_STRIDE;
+    config.writes = B_WRITES;
+
+    TraceGenerator generator(config);
+    accesses.resize(count);
+    generator.generate(accesses.data(), count);
+}
+
+//runs <accesses> through Cache::read/write on a fresh cache <repeat> times, returns the fastest
+static double timeCache(int blockSize, int assoc, int policy, const std::vector<Access>& accesses,
+                        uint repeat, double& missRatio)
+{
+    double best = 0;
+    Memory memory;
+    uint buffer = 0;
+
+    for(uint r = 0; r < repeat; r++)
+    {
+        Cache cache(&memory, B_CACHE, blockSize, assoc, policy);
+
+        double start = now();
+        for(size_t i = 0; i < accesses.size(); i++)  {
+            if(accesses[i].write)  {cache.write(accesses[i].address, &buffer, 1);}
+            else                   {cache.read(accesses[i].address, &buffer, 1);}
+        }
+        double elapsed = now() - start;
+
+        if(r == 0 || elapsed < best)  {
+            best = elapsed;
+        }
+        missRatio = (double) cache.stats.misses / cache.stats.accesses;
+    }
+
+    return best;
+}
+
+static void benchCache(uint count, uint repeat, std::vector<Result>& results)
+{
+    int assocs[] = {1, 4, 16};
+    int blocks[] = {4, 16};
+    int policies[] = {C_CRP_RANDOM, C_CRP_LRU, C_CRP_TREE, C_CRP_XORSHIFT};
+
+    for(int pattern = 0; pattern < B_PATTERNS; pattern++)
+    {
+        std::vector<Access> accesses;
+        makePattern(pattern, count, accesses);
+
+        for(int a : assocs)  {
+            for(int b : blocks)  {
+                for(int p : policies)
+                {
+                    Result result;
+                    result.name = std::string("cache/") + patternNames[pattern] + "/" + policyNames[p] +
+                                  "/assoc" + std::to_string(a) + "/block" + std::to_string(b);
+                    result.ops = count;
+                    result.seconds = timeCache(b, a, p, accesses, repeat, result.missRatio);
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+}
+
+//parses <text> with <parser> over and over into one batch, returns the fastest pass
+static double timeParse(TraceParser* parser, const std::string& text, uint repeat, unsigned long long& records)
+{
+    std::vector<Access> batch(C_BATCH_SIZE);
+    double best = 0;
+
+    for(uint r = 0; r < repeat; r++)
+    {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        records = 0;
+
+        double start = now();
+        while(p < end)  {
+            records += parser->parse(p, end, batch.data(), C_BATCH_SIZE, true);
+        }
+        double elapsed = now() - start;
+
+        if(r == 0 || elapsed < best)  {
+            best = elapsed;
+        }
+    }
+
+    return best;
+}
+
+static void benchParse(uint count, uint repeat, std::vector<Result>& results)
+{
+    std::vector<Access> accesses;
+    makePattern(C_GEN_RANDOM, count, accesses);
+
+    //the same accesses in the text and binary formats
+    std::string text, binary(C_TRAC_BIN_MAGIC "\1\0\0\0", C_TRAC_BIN_HEADER);
+    char line[C_TRAC_HEX_LEN + 8];
+    for(size_t i = 0; i < accesses.size(); i++)
+    {
+        snprintf(line, sizeof(line), "%08llx %c\n", accesses[i].address, accesses[i].write ? 'w' : 'r');
+        text += line;
+
+        for(int k = 0; k < 8; k++)  {
+            binary += (char) (accesses[i].address >> (8 * k));
+        }
+        binary += (char) (accesses[i].write ? 1 : 0);
+    }
+
+    TextTraceParser textParser;
+    textParser.configure(false);
+
+    Result result;
+    result.name = "parse/text";
+    result.seconds = timeParse(&textParser, text, repeat, result.ops);
+    result.bytesPerSecond = text.size() / result.seconds;
+    results.push_back(result);
+
+    //the binary parser skips its header once, so it gets a new parser per pass
+    double best = 0;
+    for(uint r = 0; r < repeat; r++)
+    {
+        BinaryTraceParser parser;
+        parser.configure(false);
+        double elapsed = timeParse(&parser, binary, 1, result.ops);
+        if(r == 0 || elapsed < best)  {
+            best = elapsed;
+        }
+    }
+    result.name = "parse/binary";
+    result.seconds = best;
+    result.bytesPerSecond = binary.size() / result.seconds;
+    results.push_back(result);
+}
+
+//cost of a miss over a hit: an all-hit loop against an all-miss loop of the same length,
+//clean (reads) and dirty (writes, each miss evicting a dirty block)
+static void benchMissCost(uint count, uint repeat, std::vector<Result>& results)
+{
+    int blockSize = 4;
+    std::vector<Access> hits(count), misses(count);
+    for(uint i = 0; i < count; i++)
+    {
+        //hits cycle through half the cache; misses step a block at a time through 64 caches' worth
+        hits[i].address = (i * blockSize) % (B_CACHE / 2);
+        misses[i].address = ((addr_t) i * blockSize) % ((addr_t) B_CACHE * 64);
+    }
+
+    for(int dirty = 0; dirty < 2; dirty++)
+    {
+        for(uint i = 0; i < count; i++)  {
+            hits[i].write = dirty;
+            misses[i].write = dirty;
+        }
+
+        for(int p : {C_CRP_RANDOM, C_CRP_LRU, C_CRP_TREE, C_CRP_XORSHIFT})
+        {
+            //the hit loop still takes its compulsory misses, so only the difference counts
+            double hitLoopMisses, missRatio;
+            double tHit = timeCache(blockSize, 4, p, hits, repeat, hitLoopMisses);
+            double tMiss = timeCache(blockSize, 4, p, misses, repeat, missRatio);
+
+            Result result;
+            result.name = std::string("miss/") + (dirty ? "dirty/" : "clean/") + policyNames[p];
+            result.ops = count;
+            result.seconds = tMiss;
+            result.missRatio = missRatio;
+            result.nsPerMiss = (tMiss - tHit) / (count * (missRatio - hitLoopMisses)) * 1e9;
+            results.push_back(result);
+        }
+    }
+}
+
+static void writeJson(std::ostream& out, const std::vector<Result>& results, uint count, uint repeat)
+{
+    out << "{" << std::endl;
+    out << "  \"accesses\": " << count << "," << std::endl;
+    out << "  \"repeat\": " << repeat << "," << std::endl;
+    out << "  \"benchmarks\": [" << std::endl;
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+            << ", \"seconds\": " << r.seconds << ", \"ops_per_second\": " << r.ops / r.seconds;
+        if(r.missRatio >= 0)       {out << ", \"miss_ratio\": " << r.missRatio;}
+        if(r.nsPerMiss >= 0)       {out << ", \"ns_per_miss\": " << r.nsPerMiss;}
+        if(r.bytesPerSecond >= 0)  {out << ", \"bytes_per_second\": " << r.bytesPerSecond;}
+        out << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+/*-------------------------------------------------------------------------------------------------
+*    Function Name : main
+*    Args          : optional flags
+*                       --accesses N    accesses (or trace records) per run (default 256K)
+*                       --repeat R      runs per benchmark, the fastest is reported (default 3)
+*                       --only S        cache, parse or miss: run just that group
+*                       --out F         write the JSON there instead of stdout
+*    Return Type   : int(0)
+*    Application   : Runs the benchmarks and prints the results as JSON
+-------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    uint count = B_ACCESSES;
+    uint repeat = B_REPEAT;
+    std::string only, outPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string flag = argv[i];
+        if(i + 1 >= argc)  {
+            std::cerr << "missing value for " << flag << std::endl;
+            return 1;
+        }
+
+        if(flag == "--accesses")      {count = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--repeat")   {repeat = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--only")
+        {
+            only = argv[++i];
+            if(only != "cache" && only != "parse" && only != "miss")  {
+                std::cerr << "--only expects cache, parse or miss" << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--out")      {outPath = argv[++i];}
+        else  {
+            std::cerr << "unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+    if(count == 0 || repeat == 0)  {
+        std::cerr << "--accesses and --repeat must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    if(only.empty() || only == "cache")  {benchCache(count, repeat, results);}
+    if(only.empty() || only == "parse")  {benchParse(count, repeat, results);}
+    if(only.empty() || only == "miss")   {benchMissCost(count, repeat, results);}
+
+    if(outPath.empty())  {
+        writeJson(std::cout, results, count, repeat);
+    }
+    else
+    {
+        std::ofstream out(outPath.c_str());
+        if(!out)  {
+            std::cerr << "cannot write " << outPath << std::endl;
+            return 1;
+        }
+        writeJson(out, results, count, repeat);
+    }
+
+    return 0;
+}
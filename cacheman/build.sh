@@ -0,0 +1,5 @@
+g++ -O2 -ffp-contract=off -pthread -fPIC -c cache.cpp stats.cpp trace.cpp timing.cpp mmu.cpp server.cpp perf.cpp capi.cpp
+ar rcs libcacheman.a cache.o stats.o trace.o timing.o mmu.o server.o perf.o capi.o
+g++ -shared -pthread cache.o stats.o trace.o timing.o mmu.o server.o perf.o capi.o -o libcacheman.so
+g++ -O2 -ffp-contract=off -pthread main.cpp libcacheman.a -o cacheman
+g++ -O2 -ffp-contract=off -pthread bench.cpp libcacheman.a -o bench
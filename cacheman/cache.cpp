@@ -1,46 +1,19 @@
-#include <iostream>
-#include <fstream>
+#include "cache.h"
+#include "policy.h"
+
+#include <algorithm>
 #include <cassert>
-#include <iterator>
-#include <set>
 #include <cstring>
+#include <sstream>
+#include <cmath>
 
 /*-------------------------------------------------------------------------------------------------
 *    Author   : Team DOOFENSMARTZ
 *    Code     : CPP code for a Cache Simulator
 *    Question : CS2610 A6
+*    Build    : build.sh (libcacheman.a and .so, then the cacheman CLI and bench against them)
 -------------------------------------------------------------------------------------------------*/
 
-typedef unsigned int uint;
-typedef unsigned char word; //unused, need to switch over
-
-// Cache Replacement Policies
-#define C_CRP_LRU     1
-#define C_CRP_RANDOM  0
-#define C_CRP_TREE   2
-
-// Output Scheme
-#define C_COUT 0
-#define C_HOUT 1
-
-// Input Scheme
-#define C_CIN 0
-#define C_HIN 1
-
-// Address Constraints
-#define C_TRAC_HEX_LEN 8
-#define C_ADDR_LEN 32
-
-// Miss indicators
-#define C_HIT 0
-#define C_MISS_INV 1
-#define C_MISS_VAL 2
-#define C_MISS_DIR 3
-
-//Note: Cache supports 32-bits, but leading bit is masked off since
-//      it indicates r/w. If input is provided and processed differently
-//      in main(), Cache can handle 32-bit addresses.
-
 //////      UTILITY FUNCTIONS      //////
 
 int log2(uint x)
@@ -67,251 +40,96 @@ int pow2(uint n)
     return r;
 }
 
-//////      CLASSES      //////
-
-class Memory;
-class CacheBlock;
-class Set;
-class VictimManager;
-class RandomVictimManager;
-class LRUVictimManager;
-class TreeVictimManager;
-class Cache;
-
-/*-------------------------------------------------------------------------------------------------
-*    Class Name         : Memory
-*    Application        : Simulates memory
-*    Inheritances       : Nil
--------------------------------------------------------------------------------------------------*/
-
-class Memory
-{
-public:
-    //reads <wordCount> words from memory into buffer[]
-    void read(uint addr, uint* buffer, uint wordCount = 1);
-    void write(uint addr, uint* buffer, uint wordCount = 1);
-};
+//////////////////////////////////////////////////////////////////////
+/////////////////////     MEMORY DEFINITIONS     /////////////////////
+//////////////////////////////////////////////////////////////////////
 
-/*-------------------------------------------------------------------------------------------------
-*    Class Name         : CacheBlock
-*    Application        : Used to represent a block of data in a cache
-*    Inheritances       : Nil
--------------------------------------------------------------------------------------------------*/
-class CacheBlock
+Memory::Memory(bool backed)
 {
-private:
-    int    tag = -1;         //stores tag
-    bool   dirty = false;    //any writes to block?
-    bool   valid = false;    //any reads into block?
-    
-    int    blockSize;
-    uint*  data = NULL;      //stores data of the cacheBlock
-
-    //gets offset from an address
-    uint getOffset(uint addr);
-public:
-    //constructor: inits data
-    CacheBlock(int blockSize);
-    
-    //getters and setters
-    bool isValid();
-    bool isDirty();
-    
-    uint getTag();
-    void setTag(uint tag);
-
-    //writes <count> words into <data> from this block given the address
-    void write(uint address, uint* data, uint count = 1);
-    void read(uint address, uint* data, uint count = 1);
-};
+    this->backed = backed;
+}
 
-//adds doubly-linked-list functionality to CacheBlock
-typedef struct BlockNodest
+Memory::~Memory()
 {
-    CacheBlock*          block = NULL;
-    struct BlockNodest*  prev  = NULL;
-    struct BlockNodest*  next  = NULL;
-}  BlockNode;
-
-/*-------------------------------------------------------------------------------------------------
-*    Class Name         : Set
-*    Application        : Used to represent a set of blocks
-*    Inheritances       : Nil
--------------------------------------------------------------------------------------------------*/
-class Set
-{
-private:
-    BlockNode*  head;       //head pointer of linked list of cache blocks
-    int         size;       //size is number of blocks in the set
-    int         repPolicy;  //repPolicy is to identify replacement policy
-    int         blockSize; 
-    int         validBlocks = 0; //number of valid blocks in this set
-
-    //lengths of these fields in bits
-    int offsetLength;
-    int indexLength;
-    int tagLength;
-    //index of this set
-    int index;
-    
-    //reference to memory, and a victim manager
-    Memory* memReference;
-    VictimManager* vicMan;
-
-    //get tag from address
-    uint getTag(uint addr);
-    //reflects block access in PLRU/LRU/others
-    void reflectBlockAccess(BlockNode* blockPtr);
-    //adds new block to set, replaces victim block
-    int addNewBlock(BlockNode* blockPtr);
-    //writes back a victim block
-    void writeBack(BlockNode* victimPtr);
-
-public:
-    //constructor: many functions
-    Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int repPolicy);
-
-    //read <count> words from address into <data[]>
-    int read(uint address, uint* data, uint count = 1);
-    int write(uint address, uint* data, uint count = 1);
-
-    //friends since they access the Blocks LinkedList
-    friend class VictimManager;
-    friend class RandomVictimManager;
-    friend class LRUVictimManager;
-    friend class TreeVictimManager;
-};
-
-/*-------------------------------------------------------------------------------------------------
-*    Classes            : VictimManager (and specific implementations)
-*    Application        : Assist in tracking victims in Set
-*    Inheritances       : Nil
--------------------------------------------------------------------------------------------------*/
-//base interface/abstract class
-class VictimManager
-{
-public:
-    //triggers bookkeeping for the replacement policy when a block is accessed
-    virtual void reflectBlockAccess(BlockNode* accessedPtr) = 0;
-    //gets the victim block address
-    virtual BlockNode* getVictim() = 0; //inclusive of invalid blocks
-};
+    for(size_t i = 0; i < slabs.size(); i++)  {
+        delete[] slabs[i];
+    }
+}
 
-//random (counter-based, not random in the exact sense)
-//advantage: no need to check block validity
-class RandomVictimManager : public VictimManager
+uint* Memory::getPage(addr_t addr, bool create)
 {
-private:
-    uint counter = 0;   //iterates across block linked list
-    Set* setRef = NULL; //refers to original set
-public:
-    RandomVictimManager(Set* sR);
-
-    //nothing to reflect here
-    void reflectBlockAccess(BlockNode* accessedPtr)  {}
-    BlockNode* getVictim();
-};
+    addr_t number = addr / C_MEM_PAGE_WORDS;
+    std::unordered_map<addr_t, uint*>::iterator it = pages.find(number);
+    if(it != pages.end())  {
+        return it->second;
+    }
+    if(!create)  {
+        return NULL;
+    }
 
-//least recently used: brings accessed block to head
-//evicted: last block
-class LRUVictimManager : public VictimManager
-{
-private:
-    Set* setRef = NULL;
-public:
-    LRUVictimManager(Set* sR);
+    //carve the next page out of the pool, zeroed
+    if(slabUsed == C_MEM_SLAB)  {
+        slabs.push_back(new uint[(size_t) C_MEM_PAGE_WORDS * C_MEM_SLAB]());
+        slabUsed = 0;
+    }
+    uint* page = slabs.back() + (size_t) slabUsed * C_MEM_PAGE_WORDS;
+    slabUsed++;
 
-    void reflectBlockAccess(BlockNode* accessedPtr);
-    BlockNode* getVictim();
-};
+    pages[number] = page;
+    return page;
+}
 
-//tree-based psuedo-lru: uses a complete binary tree
-class TreeVictimManager : public VictimManager
+void Memory::read(addr_t addr, uint* buffer, uint wordCount)
 {
-private:
-    //a bool array representing the tree
-    bool* tree = NULL;
-    Set* setRef = NULL;
+    //tag-only: nothing stored, reads give zeros
+    if(!backed)
+    {
+        memset(buffer, 0, wordCount * sizeof(uint));
+        return;
+    }
 
-    //needed for tree implementation
-    uint setSize;
-public:
-    TreeVictimManager(Set* sR);
+    //page by page, never-written pages read as zeros without being allocated
+    while(wordCount > 0)
+    {
+        uint offset = addr % C_MEM_PAGE_WORDS;
+        uint run = C_MEM_PAGE_WORDS - offset;
+        if(run > wordCount)  {
+            run = wordCount;
+        }
 
-    void reflectBlockAccess(BlockNode* accessedPtr);
-    BlockNode* getVictim();
-};
+        uint* page = getPage(addr, false);
+        if(page != NULL)  {memcpy(buffer, page + offset, run * sizeof(uint));}
+        else              {memset(buffer, 0, run * sizeof(uint));}
 
+        addr += run;
+        buffer += run;
+        wordCount -= run;
+    }
+}
 
-/*-------------------------------------------------------------------------------------------------
-*    Class Name         : Cache
-*    Application        : Used to represent the cache
-*    Inheritances       : Nil
--------------------------------------------------------------------------------------------------*/
-class Cache
+void Memory::write(addr_t addr, uint* buffer, uint wordCount)
 {
-private:
-    int numSets;   //number of sets in the cache
-    int numWays;    //number of ways in the cache
-    int numBlocks;  //number of blocks in the cache
-
-    int cacheSize;  //size of the cache (words)
-    int blockSize;  //size of the cache block (words)
-
-    //length of the offset field in bits in an address
-    int offsetLength;
-    
-    int repPolicy;  //replacement policy
-    Set** sets;     //pointer to represent sets
-
-    //gets an index from an address
-    uint getIndex(uint address);
-
-    //stores the accessed addresses from cache
-    //useful to determine compulsory misses
-    std::set<int, std::greater<int>> stat_addr_queried;
-public:
-    Cache(Memory* mR, int cacheSize, int blockSize, int org, int repPolicy);
-
-    //read <count> words from <address> into <buffer[]>
-    void read(uint address, uint* buffer, uint count = 1);
-    void write(uint address, uint* buffer, uint count = 1);
-
-    //statistics
-    int stat_cache_read = 0;
-    int stat_cache_write = 0;
-    int stat_cache_access = 0;
-
-    int stat_cache_miss = 0;
-    int stat_cache_miss_read = 0;
-    int stat_cache_miss_write = 0;
-
-    int stat_cache_miss_compulsory = 0;
-    int stat_cache_miss_capacity = 0;
-    int stat_cache_miss_conflict = 0;
-    
-    int stat_cache_dirty_evicted = 0;
-};
+    //tag-only: does absolutely nothing
+    if(!backed)  {
+        return;
+    }
 
+    while(wordCount > 0)
+    {
+        uint offset = addr % C_MEM_PAGE_WORDS;
+        uint run = C_MEM_PAGE_WORDS - offset;
+        if(run > wordCount)  {
+            run = wordCount;
+        }
 
-//////////////////////////////////////////////////////////////////////
-/////////////////////     MEMORY DEFINITIONS     /////////////////////
-//////////////////////////////////////////////////////////////////////
+        memcpy(getPage(addr, true) + offset, buffer, run * sizeof(uint));
 
-void Memory::read(uint addr, uint* buffer, uint wordCount)
-{
-    //dummy memory, does nothing
-    for(uint i = 0; i < wordCount; i++)
-    {
-        buffer[i] = 0;
+        addr += run;
+        buffer += run;
+        wordCount -= run;
     }
 }
 
-void Memory::write(uint addr, uint* buffer, uint wordCount)
-{
-    //does absolutely nothing
-}
-
 //////////////////////////////////////////////////////////////////////
 /////////////////////     BLOCK DEFINITIONS     //////////////////////
 //////////////////////////////////////////////////////////////////////
@@ -323,8 +141,13 @@ CacheBlock::CacheBlock(int blockSize)
     this->data      = new uint[blockSize];
 }
 
+CacheBlock::~CacheBlock()
+{
+    delete[] data;
+}
+
 //gets offset from address
-uint CacheBlock::getOffset(uint addr)
+uint CacheBlock::getOffset(addr_t addr)
 {
     //gets last bits
     return addr & (blockSize - 1);
@@ -333,10 +156,37 @@ uint CacheBlock::getOffset(uint addr)
 //getters and setters
 bool CacheBlock::isValid()          {return valid;}
 bool CacheBlock::isDirty()          {return dirty;}
-uint CacheBlock::getTag()           {return tag;}
-void CacheBlock::setTag(uint tag)   {this->tag = tag;}
+void CacheBlock::reset()            {valid = false; dirty = false; sectorValid = 0; sectorDirty = 0;}
+
+void CacheBlock::setSectorSize(uint words)
+{
+    sectorSize = words;
+}
+
+unsigned long long CacheBlock::getSectorMask(addr_t address, uint count)
+{
+    uint first = getOffset(address) / sectorSize;
+    uint last = (getOffset(address) + count - 1) / sectorSize;
+    unsigned long long upto = (last >= 63) ? ~0ULL : ((1ULL << (last + 1)) - 1);
+    return upto & ~((1ULL << first) - 1);
+}
 
-void CacheBlock::write(uint address, uint* data, uint count)
+void CacheBlock::load(addr_t address, uint* data, uint count)
+{
+    uint offset = getOffset(address);
+    assert(offset + count <= blockSize);
+
+    valid = true;
+    if(sectorSize > 0)  {
+        sectorValid |= getSectorMask(address, count);
+    }
+    for(int i = 0; i < count; i++)
+    {
+        this->data[offset + i] = data[i];
+    }
+}
+
+void CacheBlock::write(addr_t address, uint* data, uint count)
 {
     uint offset = getOffset(address);
 
@@ -345,7 +195,15 @@ void CacheBlock::write(uint address, uint* data, uint count)
 
     //first write: valid false => dirty false (getting from memory into block)
     //second write: dirty: true
-    dirty = valid;
+    //sectored blocks are filled through load(), so every write here dirties
+    if(sectorSize > 0)  {
+        assert((sectorValid & getSectorMask(address, count)) == getSectorMask(address, count));
+        dirty = true;
+        sectorDirty |= getSectorMask(address, count);
+    }
+    else  {
+        dirty = valid;
+    }
     valid = true;
 
     //write data into the block, from given data[]   
@@ -355,7 +213,7 @@ void CacheBlock::write(uint address, uint* data, uint count)
     }
 }
 
-void CacheBlock::read(uint address, uint* data, uint count)
+void CacheBlock::read(addr_t address, uint* data, uint count)
 {
     uint offset = getOffset(address);
 
@@ -394,16 +252,27 @@ BlockNode* RandomVictimManager::getVictim()
 
     //increment counter
     counter = (counter + 1) % setRef->size;;
-    
-    //traverse linked list to invalid/victim location
-    BlockNode* tmp = setRef->head;
-    while(t > 0)  {
-        tmp = tmp->next;
-        t--;
+
+    //ways[] maps the slot straight to its node
+    return setRef->ways[t];
+}
+
+XorshiftVictimManager::XorshiftVictimManager(Set* sR)
+{
+    this->setRef = sR;
+}
+
+BlockNode* XorshiftVictimManager::getVictim()
+{
+    if(setRef->preferInvalid && setRef->validBlocks < setRef->size)  {
+        for(int w = 0; w < setRef->size; w++)  {
+            if(!setRef->ways[w]->block->isValid())  {
+                return setRef->ways[w];
+            }
+        }
     }
 
-    //return the node's address
-    return tmp;
+    return setRef->ways[pickRandom(*setRef->randomState, setRef->size)];
 }
 
 LRUVictimManager::LRUVictimManager(Set* sR)
@@ -413,10 +282,14 @@ LRUVictimManager::LRUVictimManager(Set* sR)
 
 void LRUVictimManager::reflectBlockAccess(BlockNode* accessedPtr)
 {
+    //already the most recently used block
+    if(accessedPtr->prev == NULL)  {
+        return;
+    }
+
     //store current head
     BlockNode* tmp = setRef->head;
 
-
     //remove accessed block from middle of set
     if(accessedPtr->prev != NULL)  {
         accessedPtr->prev->next = accessedPtr->next;
@@ -455,6 +328,11 @@ TreeVictimManager::TreeVictimManager(Set* sR)
     tree = new bool[setSize - 1]();
 }
 
+TreeVictimManager::~TreeVictimManager()
+{
+    delete[] tree;
+}
+
 void TreeVictimManager::reflectBlockAccess(BlockNode* accessedPtr)
 {
     //intent: make bits in the path to root point away
@@ -468,8 +346,8 @@ void TreeVictimManager::reflectBlockAccess(BlockNode* accessedPtr)
     }
 
     //adjusted for 0-based indexing
-    int curr = index + setSize - 1; //issue: curr is int here
-    while(curr > -1)
+    int curr = index + setSize - 1;
+    while(curr > 0)
     {
         //make the parent bit point away
         tree[(curr - 1) / 2] = (curr % 2);
@@ -509,9 +387,54 @@ BlockNode* TreeVictimManager::getVictim()
 ///////////////////////    SET DEFINITIONS     ///////////////////////
 //////////////////////////////////////////////////////////////////////
 
-uint Set::getTag(uint addr)
+addr_t Set::getTag(addr_t addr)
+{
+    return (addr >> tagShift) & tagMask;
+}
+
+addr_t Set::getWayTag(int way)
 {
-    return (addr >> (C_ADDR_LEN - tagLength));
+    if(tagWidth == 16)       {return tags.t16[way];}
+    else if(tagWidth == 32)  {return tags.t32[way];}
+    else                     {return tags.t64[way];}
+}
+
+void Set::setWayTag(int way, addr_t tag)
+{
+    if(tagWidth == 16)       {tags.t16[way] = (uint16_t) tag;}
+    else if(tagWidth == 32)  {tags.t32[way] = (uint32_t) tag;}
+    else                     {tags.t64[way] = tag;}
+}
+
+//first way at or after <from> holding <tag>, -1 if none
+template <typename T>
+static inline int scanTags(const T* tags, int ways, T tag, int from)
+{
+    for(int w = from; w < ways; w++)  {
+        if(tags[w] == tag)  {
+            return w;
+        }
+    }
+    return -1;
+}
+
+BlockNode* Set::lookup(addr_t tag)
+{
+    //invalid ways keep stale tags, so scan on past those
+    int way = -1;
+    while(true)
+    {
+        if(tagWidth == 16)       {way = scanTags(tags.t16, size, (uint16_t) tag, way + 1);}
+        else if(tagWidth == 32)  {way = scanTags(tags.t32, size, (uint32_t) tag, way + 1);}
+        else                     {way = scanTags(tags.t64, size, tag, way + 1);}
+
+        if(way < 0)  {
+            return NULL;
+        }
+        if(ways[way]->block->isValid())  {
+            return ways[way];
+        }
+    }
 }
 
 void Set::reflectBlockAccess(BlockNode* blockPtr)
@@ -519,7 +442,7 @@ void Set::reflectBlockAccess(BlockNode* blockPtr)
     vicMan->reflectBlockAccess(blockPtr);
 }
 
-int Set::addNewBlock(BlockNode* blockPtr)
+int Set::fill(addr_t address, BlockNode*& filled)
 {
     int hitstatus; //for stats
 
@@ -544,38 +467,136 @@ int Set::addNewBlock(BlockNode* blockPtr)
         validBlocks++;
     }
 
-    //add new block into list
-    if(victimPtr->prev != NULL)
+    refill(victimPtr, address);
+    reflectBlockAccess(victimPtr);
+
+    filled = victimPtr;
+    return hitstatus;
+}
+
+void Set::refill(BlockNode* victimPtr, addr_t address)
+{
+    //fetch the new block over the victim, which keeps its way (and list position)
+    addr_t readaddr = getBlockBase(address);
+    stat_block_fills++;
+
+    victimPtr->block->reset();
+    setWayTag(victimPtr->way, getTag(readaddr));
+
+    //sectored: the caller fetches just the sectors it touches
+    if(sectorSize > 0)  {
+        return;
+    }
+
+    memReference->read(readaddr, buffer, blockSize);
+    victimPtr->block->write(readaddr, buffer, blockSize);
+    stat_words_fetched += blockSize;
+}
+
+bool Set::fetchSectors(BlockNode* blockPtr, addr_t address, uint count)
+{
+    if(sectorSize == 0)  {
+        return false;
+    }
+
+    CacheBlock* block = blockPtr->block;
+    unsigned long long missing = block->getSectorMask(address, count) & ~block->getValidSectors();
+    if(missing == 0)  {
+        return false;
+    }
+
+    addr_t base = getBlockBase(address);
+    while(missing != 0)
     {
-        victimPtr->prev->next = blockPtr;
-        blockPtr->prev = victimPtr->prev;
+        int sector = __builtin_ctzll(missing);
+        missing &= missing - 1;
+
+        addr_t readaddr = base + sector * sectorSize;
+        memReference->read(readaddr, buffer, sectorSize);
+        block->load(readaddr, buffer, sectorSize);
+        stat_words_fetched += sectorSize;
+    }
+    return true;
+}
+
+void Set::setSectorSize(uint words)
+{
+    sectorSize = words;
+    for(int i = 0; i < size; i++)  {
+        ways[i]->block->setSectorSize(words);
+    }
+}
+
+BlockNode* Set::probeWay(int way, addr_t address)
+{
+    BlockNode* node = ways[way];
+    if(node->block->isValid() && getWayTag(way) == getTag(address))  {
+        return node;
     }
-    if(victimPtr->next != NULL)
+    return NULL;
+}
+
+int Set::fillWay(int way, addr_t address, BlockNode*& filled)
+{
+    //the caller picked the way, so the victim manager is bypassed;
+    //any valid victim counts as a conflict, the cache has no single set to be full
+    BlockNode* victimPtr = ways[way];
+    int hitstatus = C_MISS_INV;
+
+    if(victimPtr->block->isValid())
     {
-        victimPtr->next->prev = blockPtr;
-        blockPtr->next = victimPtr->next;
+        hitstatus = C_MISS_VAL;
+        if(victimPtr->block->isDirty())
+        {
+            hitstatus = C_MISS_DIR;
+            writeBack(victimPtr);
+        }
+    }
+    else
+    {
+        validBlocks++;
     }
-    reflectBlockAccess(blockPtr);
-    //get rid of the victim block
-    delete victimPtr;
 
+    refill(victimPtr, address);
+
+    filled = victimPtr;
     return hitstatus;
 }
 
 void Set::writeBack(BlockNode* victimPtr)
 {
     //compute address in memory
-    uint memAddr = victimPtr->block->getTag();
-    memAddr = (memAddr << indexLength) + index;
+    addr_t memAddr = getWayTag(victimPtr->way);
+    if(tagShift == offsetLength + indexLength)  {
+        memAddr = (memAddr << indexLength) + index;
+    }
     memAddr = (memAddr << offsetLength);
+    stat_block_writebacks++;
+
+    //sectored: only the dirty sectors go back
+    if(sectorSize > 0)
+    {
+        unsigned long long dirty = victimPtr->block->getDirtySectors();
+        while(dirty != 0)
+        {
+            int sector = __builtin_ctzll(dirty);
+            dirty &= dirty - 1;
+
+            victimPtr->block->read(sector * sectorSize, buffer, sectorSize);
+            memReference->write(memAddr + sector * sectorSize, buffer, sectorSize);
+            stat_words_written += sectorSize;
+        }
+        return;
+    }
 
     //write the block into memory
-    uint* buffer = new uint[blockSize];
     victimPtr->block->read(0, buffer, blockSize);
     memReference->write(memAddr, buffer, blockSize);
+    stat_words_written += blockSize;
 }
 
-Set::Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int repPolicy)
+Set::Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int repPolicy, int addrBits,
+         bool blockTags)
 {
     //absorb params
     this->memReference = mR;
@@ -587,13 +608,39 @@ Set::Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int rep
     this->repPolicy = repPolicy;
 
     //calculate addr fields' lengths
-    offsetLength = log2(blockSize);
-    indexLength = log2(numSets);
-    tagLength = C_ADDR_LEN - (offsetLength + indexLength);
+    offsetLength = log2((uint) blockSize);
+    indexLength = log2((uint) numSets);
+    tagShift = blockTags ? offsetLength : offsetLength + indexLength;
+    tagLength = addrBits - tagShift;
+    if(tagLength < 1)  {
+        tagLength = 1;
+    }
+    tagMask = (tagLength >= 64) ? ~(addr_t) 0 : (((addr_t) 1 << tagLength) - 1);
+    addrMask = (tagShift + tagLength >= 64) ? ~(addr_t) 0 : (((addr_t) 1 << (tagShift + tagLength)) - 1);
+
+    //narrowest tag array that holds tagLength bits
+    if(tagLength <= 16)  {
+        tagWidth = 16;
+        tags.t16 = new uint16_t[setSize]();
+    }
+    else if(tagLength <= 32)  {
+        tagWidth = 32;
+        tags.t32 = new uint32_t[setSize]();
+    }
+    else  {
+        tagWidth = 64;
+        tags.t64 = new addr_t[setSize]();
+    }
+
+    //scratch block for fills and writebacks
+    buffer = new uint[blockSize];
 
     //allocate blocks
+    ways = new BlockNode*[setSize];
+
     this->head = new BlockNode(); 
     this->head->block = new CacheBlock(blockSize);
+    ways[0] = this->head;
 
     BlockNode* temp = this->head;
 
@@ -602,6 +649,8 @@ Set::Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int rep
         temp->next = new BlockNode();
         temp->next->block = new CacheBlock(blockSize);
         temp->next->prev = temp;
+        temp->next->way = i;
+        ways[i] = temp->next;
 
         temp = temp->next;
     }
@@ -621,109 +670,99 @@ Set::Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int rep
     {
         vicMan = new TreeVictimManager(this);
     }
+    else if(repPolicy == C_CRP_XORSHIFT)
+    {
+        vicMan = new XorshiftVictimManager(this);
+    }
 }
 
-int Set::read(uint address, uint* data, uint count)
+Set::~Set()
 {
-    uint tag = getTag(address);
+    for(int i = 0; i < size; i++)  {
+        delete ways[i]->block;
+        delete ways[i];
+    }
+    delete[] ways;
+    delete[] buffer;
+    delete vicMan;
+
+    if(tagWidth == 16)       {delete[] tags.t16;}
+    else if(tagWidth == 32)  {delete[] tags.t32;}
+    else                     {delete[] tags.t64;}
+}
 
+int Set::read(addr_t address, uint* data, uint count)
+{
     //look for block
-    BlockNode* tmp = head;
+    BlockNode* tmp = lookup(getTag(address));
 
-    while(tmp != NULL)
+    if(tmp != NULL)
     {
-        if(tmp->block->isValid())
-        {
-            if(tmp->block->getTag() == tag)
-            {
-                ////// HIT ///////
+        ////// HIT ///////
 
-                //read data
-                tmp->block->read(address, data, count);
+        //a sectored block may still lack the sectors asked for
+        int hitstatus = C_HIT;
+        if(fetchSectors(tmp, address, count))  {
+            stat_sector_misses++;
+            hitstatus = C_MISS_INV;
+        }
 
-                //update block ordering (for r-policy)
-                reflectBlockAccess(tmp);
+        //read data
+        tmp->block->read(address, data, count);
 
-                return C_HIT;
-            }
-        }
+        //update block ordering (for r-policy)
+        reflectBlockAccess(tmp);
 
-        tmp = tmp->next;
+        return hitstatus;
     }
 
     ////// MISS //////
 
-    //make a new block
-    BlockNode* fetchedBlock = new BlockNode();
-    fetchedBlock->block = new CacheBlock(blockSize);
-
-    //read required location into it
-    uint* buffer = new uint[blockSize];
-    
-    uint readaddr = (address / blockSize) * blockSize;
-
-    memReference->read(readaddr, buffer, blockSize);
-    fetchedBlock->block->write(readaddr, buffer, blockSize);
-    fetchedBlock->block->setTag(getTag(readaddr));
+    //bring the block in over a victim (handles reflecting access)
+    int hitstatus = fill(address, tmp);
+    fetchSectors(tmp, address, count);
 
     //read data into given buffer
-    fetchedBlock->block->read(address, data, count);
+    tmp->block->read(address, data, count);
 
-    //add it to the set (replacing victim if needed)
-    //automatically handles reflecting access
-    return addNewBlock(fetchedBlock);
+    return hitstatus;
 }
 
-int Set::write(uint address, uint* data, uint count)
+int Set::write(addr_t address, uint* data, uint count)
 {
-    uint tag = getTag(address);
-
     //look for block
-    BlockNode* tmp = head;
-    
-    while(tmp != NULL)
+    BlockNode* tmp = lookup(getTag(address));
+
+    if(tmp != NULL)
     {
-        if(tmp->block->isValid())
-        {
-            if(tmp->block->getTag() == tag)
-            {
-                ////// HIT //////
+        ////// HIT //////
 
-                //write data
-                tmp->block->write(address, data, count);
+        //a sectored block may still lack the sectors asked for
+        int hitstatus = C_HIT;
+        if(fetchSectors(tmp, address, count))  {
+            stat_sector_misses++;
+            hitstatus = C_MISS_INV;
+        }
 
-                //update block ordering (for r-policy)
-                reflectBlockAccess(tmp);
+        //write data
+        tmp->block->write(address, data, count);
 
-                return C_HIT;
-            }
-        }
+        //update block ordering (for r-policy)
+        reflectBlockAccess(tmp);
 
-        tmp = tmp->next;
+        return hitstatus;
     }
 
     ////// MISS //////
 
-    //make a new block
-    BlockNode* fetchedBlock = new BlockNode();
-    fetchedBlock->block = new CacheBlock(blockSize);
-
-    //read from memory into it first*
-    uint* buffer = new uint[blockSize];
-
-    //make offset 0 to get block
-    uint readaddr = (address / blockSize) * blockSize;
-
-    //get block
-    memReference->read(readaddr, buffer, blockSize);
-    fetchedBlock->block->write(readaddr, buffer, blockSize);
-    fetchedBlock->block->setTag(getTag(readaddr));
+    //read from memory into a block first*
+    int hitstatus = fill(address, tmp);
+    fetchSectors(tmp, address, count);
 
     //write into it
-    fetchedBlock->block->write(address, data, count);
+    tmp->block->write(address, data, count);
 
-    //add the new block
-    return addNewBlock(fetchedBlock);
+    return hitstatus;
 
     /*
         We need to read from mem into block first since block has just 1 dirty bit for
@@ -741,7 +780,47 @@ int Set::write(uint address, uint* data, uint count)
 ////////////////////      CACHE DEFINITIONS      /////////////////////
 //////////////////////////////////////////////////////////////////////
 
-Cache::Cache(Memory* mR, int cacheSize, int blockSize, int org, int repPolicy)
+const StatDef cacheStatDefs[S_COUNT] = {
+    {"accesses",        "reads and writes simulated",                   "accesses", &CacheStats::accesses},
+    {"reads",           "reads simulated",                              "accesses", &CacheStats::reads},
+    {"writes",          "writes simulated",                             "accesses", &CacheStats::writes},
+    {"misses",          "block accesses that missed",                   "misses",   &CacheStats::misses},
+    {"compulsory",      "first touches of an address",                  "misses",   &CacheStats::compulsory},
+    {"capacity",        "misses of a fully associative cache",          "misses",   &CacheStats::capacity},
+    {"conflict",        "misses that evicted a valid block",            "misses",   &CacheStats::conflict},
+    {"read_misses",     "misses of reads",                              "misses",   &CacheStats::readMisses},
+    {"write_misses",    "misses of writes",                             "misses",   &CacheStats::writeMisses},
+    {"dirty_evictions", "evicted blocks written back to memory",        "blocks",   &CacheStats::dirtyEvictions},
+    {"block_accesses",  "accesses counted once per block they touch",   "accesses", &CacheStats::blockAccesses}
+};
+
+void addStat(StatGroup& group, const std::string& name, long long value, const char* unit,
+             const char* description)
+{
+    StatValue stat = {name, std::to_string(value), unit, description};
+    group.values.push_back(stat);
+}
+
+void addStat(StatGroup& group, const std::string& name, double value, const char* unit,
+             const char* description)
+{
+    std::ostringstream text;
+    if(std::isfinite(value))  {
+        text << value;
+    }
+    StatValue stat = {name, text.str(), unit, description};
+    group.values.push_back(stat);
+}
+
+void addCacheStats(StatGroup& group, const long long* values)
+{
+    for(int i = 0; i < S_COUNT; i++)  {
+        addStat(group, cacheStatDefs[i].name, values[i], cacheStatDefs[i].unit, cacheStatDefs[i].description);
+    }
+}
+
+Cache::Cache(Memory* mR, int cacheSize, int blockSize, int org, int repPolicy, int addrBits,
+             int indexFunc)
 {
 
     //absorb params
@@ -760,132 +839,528 @@ Cache::Cache(Memory* mR, int cacheSize, int blockSize, int org, int repPolicy)
     this->numWays = numBlocks / numSets;
     
     //calculate address field lengths
-    offsetLength = log2(blockSize);
+    offsetLength = log2((uint) blockSize);
+    indexLength = log2((uint) numSets);
+
+    //index function, hashed indices need the whole block address as the tag
+    this->indexFunc = indexFunc;
+    int blockBits = addrBits - offsetLength;
+    blockMask = (blockBits >= 64) ? ~(addr_t) 0 : (((addr_t) 1 << blockBits) - 1);
+    addrMask = (blockMask << offsetLength) | (addr_t) (blockSize - 1);
+
+    primeSets = numSets;
+    if(indexFunc == C_IDX_PRIME)  {
+        //largest prime not above numSets, the sets past it go unused
+        while(primeSets > 2)  {
+            bool prime = true;
+            for(uint d = 2; d * d <= primeSets; d++)  {
+                if(primeSets % d == 0)  {prime = false; break;}
+            }
+            if(prime)  {break;}
+            primeSets--;
+        }
+    }
+    if(indexFunc == C_IDX_SKEW)  {
+        skewStamp = new unsigned long long[numBlocks]();
+    }
+
+    scratch = new uint[blockSize]();
+    expected = new uint[blockSize]();
 
     //allocating required memory for sets
     sets = new Set*[numSets];
     for(int i = 0; i < numSets; i++)
     {
-        sets[i] = new Set(mR, i, numSets, numWays, blockSize, repPolicy);
+        sets[i] = new Set(mR, i, numSets, numWays, blockSize, repPolicy, addrBits,
+                          indexFunc != C_IDX_MODULO);
+        sets[i]->randomState = &randomState;
     }
 
     //for compulsory misses stat
     
 }
 
-uint Cache::getIndex(uint address)
+Cache::~Cache()
+{
+    for(int i = 0; i < numSets; i++)  {
+        delete sets[i];
+    }
+    delete[] sets;
+    delete[] scratch;
+    delete[] expected;
+    delete[] skewStamp;
+    delete[] setStats;
+}
+
+uint Cache::getIndex(addr_t address)
 {
-    return (address >> offsetLength) & (numSets - 1);
+    if(indexFunc == C_IDX_MODULO || numSets == 1)  {
+        return (address >> offsetLength) & (numSets - 1);
+    }
+
+    addr_t block = (address >> offsetLength) & blockMask;
+    uint mask = numSets - 1;
+
+    if(indexFunc == C_IDX_XOR)  {
+        uint index = 0;
+        while(block != 0)  {
+            index ^= block & mask;
+            block >>= indexLength;
+        }
+        return index;
+    }
+    if(indexFunc == C_IDX_PRIME)  {
+        return block % primeSets;
+    }
+    return getSkewIndex(address, 0);
 }
 
-void Cache::read(uint address, uint* buffer, uint count)
+uint Cache::getSkewIndex(addr_t address, int way)
 {
-    stat_cache_access++;
-    stat_cache_read++;
+    if(numSets == 1)  {
+        return 0;
+    }
 
-    //these two lines are actual read, others are for stats
-    uint index = getIndex(address);
-    int hitstatus = sets[index]->read(address, buffer, count);
+    //low index bits xor a per-way multiplicative hash of the bits above them,
+    //so blocks that collide in one way scatter in the others
+    addr_t block = (address >> offsetLength) & blockMask;
+    addr_t high = (block >> indexLength) + way + 1;
+    addr_t hash = (high * 0x9E3779B97F4A7C15ULL) >> (64 - indexLength);
+    return (block ^ hash) & (numSets - 1);
+}
 
-    if(hitstatus != C_HIT)  {
-        stat_cache_miss++;
-        stat_cache_miss_read++;
-        if(numSets == 1)  { //fully assoc
-            stat_cache_miss_capacity++;
+int Cache::skewAccess(addr_t address, bool write, uint* buffer, uint count, uint& index)
+{
+    BlockNode* node = NULL;
+    int way;
+    for(way = 0; way < numWays; way++)  {
+        index = getSkewIndex(address, way);
+        node = sets[index]->probeWay(way, address);
+        if(node != NULL)  {
+            break;
         }
-        if(hitstatus == C_MISS_VAL)  {
-            stat_cache_miss_conflict++;
+    }
+
+    int hitstatus = C_HIT;
+    if(node == NULL)
+    {
+        //victim among the candidate lines: an invalid one first, else by policy
+        //(tree PLRU has no cross-set tree here, so it falls back to LRU)
+        int victim = -1;
+        unsigned long long oldest = ~0ULL;
+        for(int w = 0; w < numWays && victim < 0; w++)  {
+            if(!sets[getSkewIndex(address, w)]->ways[w]->block->isValid())  {
+                victim = w;
+            }
+        }
+        if(victim < 0 && repPolicy == C_CRP_RANDOM)  {
+            victim = skewVictim;
+            skewVictim = (skewVictim + 1) % numWays;
+        }
+        if(victim < 0 && repPolicy == C_CRP_XORSHIFT)  {
+            victim = pickRandom(randomState, numWays);
         }
-        if(hitstatus == C_MISS_DIR)  {
-            stat_cache_miss_conflict++;
-            stat_cache_dirty_evicted++;
+        for(int w = 0; w < numWays && victim < 0; w++)  {
+            unsigned long long stamp = skewStamp[getSkewIndex(address, w) * numWays + w];
+            if(stamp < oldest)  {
+                oldest = stamp;
+                way = w;
+            }
+        }
+        if(victim >= 0)  {
+            way = victim;
         }
+
+        index = getSkewIndex(address, way);
+        hitstatus = sets[index]->fillWay(way, address, node);
+        sets[index]->fetchSectors(node, address, count);
+    }
+    else if(sets[index]->fetchSectors(node, address, count))
+    {
+        sets[index]->stat_sector_misses++;
+        hitstatus = C_MISS_INV;
     }
 
-    if(stat_addr_queried.find(address) == stat_addr_queried.end())  {
-        stat_addr_queried.insert(address);
-        stat_cache_miss_compulsory++;
+    skewStamp[index * numWays + way] = ++skewClock;
+    if(write)  {
+        node->block->write(address, buffer, count);
+    }
+    else  {
+        node->block->read(address, buffer, count);
     }
+    return hitstatus;
 }
 
-void Cache::write(uint address, uint* buffer, uint count)
+int Cache::lookupAccess(addr_t address, bool write, uint* buffer, uint count, uint& index)
 {
-    stat_cache_access++;
-    stat_cache_write++;
+    if(indexFunc == C_IDX_SKEW)  {
+        return skewAccess(address, write, buffer, count, index);
+    }
 
-    uint index = getIndex(address);
-    int hitstatus = sets[index]->write(address, buffer, count);
+    index = getIndex(address);
+    Set* set = sets[index];
+    return write ? set->write(address, buffer, count) : set->read(address, buffer, count);
+}
 
+void Cache::countSet(uint index, int hitstatus)
+{
+    unsigned long long* row = setStats + (size_t) index * C_SET_STATS;
+    row[C_SET_ACCESS]++;
     if(hitstatus != C_HIT)  {
-        stat_cache_miss++;
-        stat_cache_miss_write++;
-        if(numSets == 1)  { //fully assoc
-            stat_cache_miss_capacity++;
+        row[C_SET_MISS]++;
+    }
+    if(hitstatus == C_MISS_VAL || hitstatus == C_MISS_DIR)  {
+        row[C_SET_EVICT]++;
+    }
+    if(hitstatus == C_MISS_DIR)  {
+        row[C_SET_DIRTY]++;
+    }
+}
+
+void Cache::enableSetStats()
+{
+    if(setStats == NULL)  {
+        setStats = new unsigned long long[(size_t) numSets * C_SET_STATS]();
+    }
+}
+
+void Cache::reportSets(std::ostream& out, const char* prefix, uint top)
+{
+    if(setStats == NULL)  {
+        return;
+    }
+
+    //hottest sets by accesses
+    std::vector<std::pair<unsigned long long, uint>> hottest;
+    unsigned long long total = 0;
+    for(int i = 0; i < numSets; i++)  {
+        hottest.push_back(std::make_pair(setStats[(size_t) i * C_SET_STATS + C_SET_ACCESS], (uint) i));
+        total += hottest.back().first;
+    }
+    size_t shown = (hottest.size() < top) ? hottest.size() : top;
+    std::partial_sort(hottest.begin(), hottest.begin() + shown, hottest.end(),
+                      std::greater<std::pair<unsigned long long, uint>>());
+    for(size_t k = 0; k < shown; k++)  {
+        const unsigned long long* row = setStats + (size_t) hottest[k].second * C_SET_STATS;
+        out << prefix << "set " << hottest[k].second << " accesses " << row[C_SET_ACCESS]
+            << " misses " << row[C_SET_MISS] << " evictions " << row[C_SET_EVICT]
+            << " dirty " << row[C_SET_DIRTY] << std::endl;
+    }
+
+    //utilization: sets idle, then by accesses against the mean in [0,1/4) [1/4,1/2) [1/2,1)
+    //[1,2) [2,4) [4,..) of it, and the hottest set over the mean
+    unsigned long long bins[7] = {};
+    double mean = (double) total / numSets;
+    for(int i = 0; i < numSets; i++)
+    {
+        unsigned long long accesses = setStats[(size_t) i * C_SET_STATS + C_SET_ACCESS];
+        double ratio = (mean > 0) ? accesses / mean : 0;
+        int b;
+        if(accesses == 0)       {b = 0;}
+        else if(ratio < 0.25)   {b = 1;}
+        else if(ratio < 0.5)    {b = 2;}
+        else if(ratio < 1)      {b = 3;}
+        else if(ratio < 2)      {b = 4;}
+        else if(ratio < 4)      {b = 5;}
+        else                    {b = 6;}
+        bins[b]++;
+    }
+    out << prefix << "utilization";
+    for(int b = 0; b < 7; b++)  {
+        out << " " << bins[b];
+    }
+    out << " skew " << ((mean > 0 && !hottest.empty()) ? hottest[0].first / mean : 0) << std::endl;
+}
+
+void Cache::writeSetCsv(std::ostream& out)
+{
+    out << "set,accesses,misses,evictions,dirty_evictions" << std::endl;
+    for(int i = 0; i < numSets; i++)  {
+        const unsigned long long* row = setStats + (size_t) i * C_SET_STATS;
+        out << i << "," << row[C_SET_ACCESS] << "," << row[C_SET_MISS] << ","
+            << row[C_SET_EVICT] << "," << row[C_SET_DIRTY] << std::endl;
+    }
+}
+
+void Cache::setRandom(unsigned long long seed, bool preferInvalid)
+{
+    randomState = seedRandom(seed);
+    for(int i = 0; i < numSets; i++)  {
+        sets[i]->preferInvalid = preferInvalid;
+    }
+}
+
+void Cache::setSectorSize(uint words)
+{
+    for(int i = 0; i < numSets; i++)  {
+        sets[i]->setSectorSize(words);
+    }
+}
+
+void Cache::sumTraffic(unsigned long long& fetched, unsigned long long& written, unsigned long long& fills,
+                       unsigned long long& writebacks, unsigned long long& sectorMisses)
+{
+    fetched = written = fills = writebacks = sectorMisses = 0;
+    for(int i = 0; i < numSets; i++)  {
+        fetched += sets[i]->stat_words_fetched;
+        written += sets[i]->stat_words_written;
+        fills += sets[i]->stat_block_fills;
+        writebacks += sets[i]->stat_block_writebacks;
+        sectorMisses += sets[i]->stat_sector_misses;
+    }
+}
+
+void Cache::reportTraffic(std::ostream& out, const char* prefix)
+{
+    unsigned long long fetched, written, fills, writebacks, sectorMisses;
+    sumTraffic(fetched, written, fills, writebacks, sectorMisses);
+
+    unsigned long long fullFetch = fills * blockSize;
+    unsigned long long fullWrite = writebacks * blockSize;
+    out << prefix << "fetched " << fetched << " of " << fullFetch << " words, "
+        << "written back " << written << " of " << fullWrite << " words, "
+        << "saved " << (fullFetch + fullWrite - fetched - written) << " words" << std::endl;
+    out << prefix << "sector misses " << sectorMisses << std::endl;
+}
+
+void Cache::exportTraffic(StatGroup& group)
+{
+    unsigned long long fetched, written, fills, writebacks, sectorMisses;
+    sumTraffic(fetched, written, fills, writebacks, sectorMisses);
+
+    addStat(group, "words_fetched", (long long) fetched, "words", "words filled from memory");
+    addStat(group, "words_written", (long long) written, "words", "dirty words written back");
+    addStat(group, "block_fill_words", (long long) (fills * blockSize), "words",
+            "words whole-block fills would have fetched");
+    addStat(group, "block_writeback_words", (long long) (writebacks * blockSize), "words",
+            "words whole-block writebacks would have written");
+    addStat(group, "sector_misses", (long long) sectorMisses, "misses", "tag present, sector not");
+}
+
+void Cache::reportOccupancy(std::ostream& out, const char* prefix)
+{
+    //sets by valid blocks held
+    std::vector<unsigned long long> hist(numWays + 1, 0);
+    std::vector<std::pair<int, uint>> fullest;
+    for(int i = 0; i < numSets; i++)  {
+        int valid = sets[i]->getValidBlocks();
+        hist[valid]++;
+        fullest.push_back(std::make_pair(valid, (uint) i));
+    }
+
+    out << prefix << "occupancy";
+    for(int k = 0; k <= numWays; k++)  {
+        out << " " << hist[k];
+    }
+    out << std::endl;
+
+    size_t shown = (fullest.size() < C_TOP_SETS) ? fullest.size() : C_TOP_SETS;
+    std::partial_sort(fullest.begin(), fullest.begin() + shown, fullest.end(),
+                      std::greater<std::pair<int, uint>>());
+    for(size_t k = 0; k < shown; k++)  {
+        out << prefix << "set " << fullest[k].second << " valid " << fullest[k].first << std::endl;
+    }
+}
+
+void Cache::setBanks(uint numBanks, uint shift, int hash)
+{
+    this->numBanks = (numBanks > 0) ? numBanks : 1;
+    this->bankShift = shift;
+    this->bankHash = hash;
+}
+
+uint Cache::getBank(addr_t address)
+{
+    uint mask = numBanks - 1;
+    addr_t bits = address >> bankShift;
+
+    if(bankHash == C_BANK_BITS || numBanks == 1)  {
+        return bits & mask;
+    }
+
+    //fold every bank-wide field above the shift into one
+    uint width = log2(numBanks);
+    uint bank = 0;
+    while(bits != 0)  {
+        bank ^= bits & mask;
+        bits >>= width;
+    }
+    return bank;
+}
+
+int Cache::splitAccess(addr_t address, uint size, bool write, uint* buffer, AccessCounts& counts)
+{
+    bool fullyAssoc = (numSets == 1);
+    int worst = C_HIT;
+
+    if(size == 0)  {
+        size = 1;
+    }
+
+    while(size > 0)
+    {
+        //words of this piece: up to the end of the block
+        uint words = blockSize - (address & (blockSize - 1));
+        if(words > size)  {
+            words = size;
         }
-        if(hitstatus == C_MISS_VAL)  {
-            stat_cache_miss_conflict++;
+        uint* data = (buffer != NULL) ? buffer : scratch;
+        uint index;
+        int hitstatus;
+
+        if(write)  {
+            if(buffer == NULL && checkRef != NULL)  {
+                for(uint k = 0; k < words; k++)  {
+                    scratch[k] = nextValue++;
+                }
+                checkRef->write(address & addrMask, scratch, words);
+            }
+            hitstatus = lookupAccess(address, true, data, words, index);
         }
-        if(hitstatus == C_MISS_DIR)  {
-            stat_cache_miss_conflict++;
-            stat_cache_dirty_evicted++;
+        else  {
+            hitstatus = lookupAccess(address, false, data, words, index);
+            if(buffer == NULL && checkRef != NULL)  {
+                checkRef->read(address & addrMask, expected, words);
+                for(uint k = 0; k < words; k++)  {
+                    if(scratch[k] != expected[k])  {
+                        stat_data_mismatch++;
+                    }
+                }
+            }
+        }
+        if(setStats != NULL)  {
+            countSet(index, hitstatus);
+        }
+
+        counts.blocks++;
+        if(hitstatus != C_HIT)  {
+            counts.misses++;
+            if(write)  {counts.missWrites++;}
+            else       {counts.missReads++;}
+
+            if(fullyAssoc)  {
+                counts.capacity++;
+            }
+            if(hitstatus == C_MISS_VAL)  {
+                counts.conflict++;
+            }
+            if(hitstatus == C_MISS_DIR)  {
+                counts.conflict++;
+                counts.dirtyEvicted++;
+            }
+        }
+        //C_HIT < C_MISS_INV < C_MISS_VAL < C_MISS_DIR
+        if(hitstatus > worst)  {
+            worst = hitstatus;
         }
-    }
 
-    if(stat_addr_queried.find(address) == stat_addr_queried.end())  {
-        stat_addr_queried.insert(address);
-        stat_cache_miss_compulsory++;
+        //insert() reports whether the address was new, saving a separate find()
+        if(stat_addr_queried.insert(address).second)  {
+            counts.compulsory++;
+        }
+
+        address += words;
+        size -= words;
+        if(buffer != NULL)  {
+            buffer += words;
+        }
     }
+
+    return worst;
 }
 
-/*-------------------------------------------------------------------------------------------------
-*    Function Name : main
-*    Args          : Nil
-*    Return Type   : int(0)
-*    Application   : Entry point to the Proram
--------------------------------------------------------------------------------------------------*/
-int main()
+void Cache::flush(const AccessCounts& counts)
+{
+    stats.accesses += counts.reads + counts.writes;
+    stats.blockAccesses += counts.blocks;
+    stats.reads += counts.reads;
+    stats.writes += counts.writes;
+
+    stats.misses += counts.misses;
+    stats.readMisses += counts.missReads;
+    stats.writeMisses += counts.missWrites;
+
+    stats.compulsory += counts.compulsory;
+    stats.capacity += counts.capacity;
+    stats.conflict += counts.conflict;
+
+    stats.dirtyEvictions += counts.dirtyEvicted;
+}
+
+void Cache::read(addr_t address, uint* buffer, uint count)
 {
-    std::cout << "Cache Simulator" << std::endl;
-    int cacheSize, blockSize, org, repPolicy;   //parameters required to define the cache
-    char command;
-    uint buffer;
-    std::string hexCode;   //hexcode for request and address
-    std::string filename;
+    AccessCounts counts;
+    counts.reads = 1;
+    splitAccess(address, count, false, buffer, counts);
+    flush(counts);
+}
 
-    std::cin >> cacheSize >> blockSize >> org >> repPolicy;  //cache parameters
-    std::cin >> filename;   //taking input for the filename
-    std::ifstream fileObj;       //ofstream class object for the file Handling
-    fileObj.open(filename, std::ios::in); //opens a file for reading
+void Cache::write(addr_t address, uint* buffer, uint count)
+{
+    AccessCounts counts;
+    counts.writes = 1;
+    splitAccess(address, count, true, buffer, counts);
+    flush(counts);
+}
 
-    Memory* MainMem = new Memory(); //creating a main memory object
-    Cache L1(MainMem,cacheSize, blockSize, org, repPolicy); //creating a cache object
+void Cache::access(const Access* accesses, uint count, bool fetch, unsigned char* status)
+{
+    //local counters, flushed into the stat fields at the end
+    AccessCounts counts;
 
-    while(fileObj >> hexCode)   //while EOF is not reached
+    for(uint i = 0; i < count; i++)
     {
-        fileObj >> command;
-        if(command == 'r')
-            L1.read(std::stoi(hexCode,0,16), &buffer);
+#ifdef __GNUC__
+        //pull in the set (and its first block) for an upcoming access
+        if(i + C_PREFETCH_DIST < count)  {
+            Set* upcoming = sets[getIndex(accesses[i + C_PREFETCH_DIST].address)];
+            __builtin_prefetch(upcoming);
+            __builtin_prefetch(upcoming->head);
+        }
+#endif
+
+        if(accesses[i].fetch != fetch)  {
+            counts.skipped++;
+            if(status != NULL)  {
+                status[i] = C_SKIPPED;
+            }
+            continue;
+        }
+
+        if(accesses[i].write)  {counts.writes++;}
+        else                   {counts.reads++;}
 
-        else if(command == 'w')
-            L1.write(std::stoi(hexCode,0,16), &buffer);
+        int hitstatus = splitAccess(accesses[i].address, accesses[i].size, accesses[i].write, NULL, counts);
+        if(status != NULL)  {
+            status[i] = hitstatus;
+        }
     }
 
-    std::cout << L1.stat_cache_access << std::endl;
-    std::cout << L1.stat_cache_read << std::endl;
-    std::cout << L1.stat_cache_write << std::endl;
-    std::cout << L1.stat_cache_miss << std::endl;
-    std::cout << L1.stat_cache_miss_compulsory << std::endl;
+    flush(counts);
+}
 
-    if(!org)
-        std::cout << L1.stat_cache_miss_capacity << std::endl;
+void Cache::warm(const Access& access)
+{
+    addr_t address = access.address;
+    uint size = (access.size > 0) ? access.size : 1;
 
-    else
-        std::cout << 0 << std::endl;
-    std::cout << L1.stat_cache_miss_conflict << std::endl;
-    std::cout << L1.stat_cache_miss_read << std::endl;
-    std::cout << L1.stat_cache_miss_write << std::endl;
-    std::cout << L1.stat_cache_dirty_evicted << std::endl;
-    
-    fileObj.close();    //closing the inputfile
-    return 0;   //succesful run of the code
-}
\ No newline at end of file
+    while(size > 0)
+    {
+        uint words = blockSize - (address & (blockSize - 1));
+        if(words > size)  {
+            words = size;
+        }
+        uint index;
+        lookupAccess(address, access.write, scratch, words, index);
+
+        address += words;
+        size -= words;
+    }
+}
+
+void Cache::snapshot(long long* values)
+{
+    for(int i = 0; i < S_COUNT; i++)  {
+        values[i] = stats.*cacheStatDefs[i].field;
+    }
+}
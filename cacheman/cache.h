@@ -0,0 +1,532 @@
+#ifndef CACHEMAN_CACHE_H
+#define CACHEMAN_CACHE_H
+
+#include <iostream>
+#include <set>
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Memory, blocks, sets and the Cache itself: the core of the simulator
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+typedef unsigned int uint;
+typedef unsigned long long addr_t;  //simulated address, up to C_ADDR_LEN bits
+typedef unsigned char word; //unused, need to switch over
+
+// Cache Replacement Policies
+#define C_CRP_LRU     1
+#define C_CRP_RANDOM  0
+#define C_CRP_TREE   2
+#define C_CRP_XORSHIFT 3    //seeded pseudo-random way (see Cache::setRandom)
+
+// Output Scheme
+#define C_COUT 0
+#define C_HOUT 1
+
+// Input Scheme
+#define C_CIN 0
+#define C_HIN 1
+
+// Address Constraints
+#define C_TRAC_HEX_LEN 16
+#define C_ADDR_LEN 64       //widest address supported
+#define C_ADDR_BITS 48      //default address width (--addr-bits)
+
+// Batching
+#define C_BATCH_SIZE 4096   //accesses handed to Cache::access() at a time
+#define C_PREFETCH_DIST 8   //how far ahead Cache::access() prefetches set metadata
+#define C_BATCH_POOL 4      //batch buffers shared by the reader and simulation threads (power of 2)
+#define C_ACCESS_MAX 1024   //largest Access::size the server and C API take: one 4 KiB page
+
+// Miss indicators
+#define C_HIT 0
+#define C_MISS_INV 1
+#define C_MISS_VAL 2
+#define C_MISS_DIR 3
+#define C_SKIPPED  4    //left to another cache (see Cache::access)
+
+// Backing memory
+#define C_MEM_PAGE_WORDS 1024   //4 KiB pages of 32-bit words
+#define C_MEM_SLAB 64           //pages carved out of each pooled allocation
+
+// Reports
+#define C_TOP_SETS 10   //sets listed in per-set reports
+
+// Set index functions
+#define C_IDX_MODULO 0  //index = block address bits above the offset
+#define C_IDX_XOR    1  //index = every index-wide field of the block address xor-folded
+#define C_IDX_PRIME  2  //index = block address modulo the largest prime <= number of sets
+#define C_IDX_SKEW   3  //skewed-associative: each way hashes the block address its own way
+
+// Per-set counters, by set*C_SET_STATS+slot (see Cache::enableSetStats)
+#define C_SET_ACCESS 0
+#define C_SET_MISS   1
+#define C_SET_EVICT  2
+#define C_SET_DIRTY  3
+#define C_SET_STATS  4
+
+// Bank selection
+#define C_BANK_BITS 0   //bank = address bits above the bank shift
+#define C_BANK_XOR  1   //bank = those bits xor-folded with every higher bank-wide field
+
+// Stat slots: CacheStats counters in the order main() prints them (see cacheStatDefs)
+#define S_ACCESS    0
+#define S_READ      1
+#define S_WRITE     2
+#define S_MISS      3
+#define S_COMP      4
+#define S_CAP       5
+#define S_CONF      6
+#define S_MISS_R    7
+#define S_MISS_W    8
+#define S_DIRTY     9
+#define S_BLOCK     10
+#define S_COUNT     11
+#define S_PRINTED   10  //slots main() prints as bare numbers, the rest only go to exports
+
+//Note: Cache supports addresses up to 64 bits; bits above the configured
+//      address width are ignored. Each Set keeps its tags in the narrowest
+//      of 16/32/64-bit arrays that holds the tag field.
+
+//////      UTILITY FUNCTIONS      //////
+
+//floor of log2(x), -1 for 0
+int log2(uint x);
+
+//splitmix64 of a seed: a well-mixed, never-zero xorshift state
+static inline unsigned long long seedRandom(unsigned long long seed)
+{
+    unsigned long long z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (z ^ (z >> 31)) | 1;
+}
+
+//xorshift64*
+static inline unsigned long long nextRandom(unsigned long long& state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+//uniform in [0, n), by multiply and shift instead of a division
+static inline uint pickRandom(unsigned long long& state, uint n)
+{
+    return (uint) (((nextRandom(state) >> 32) * n) >> 32);
+}
+
+//2 to the n
+int pow2(uint n);
+
+//////      CLASSES      //////
+
+class Memory;
+class CacheBlock;
+class Set;
+class VictimManager;
+class RandomVictimManager;
+class LRUVictimManager;
+class TreeVictimManager;
+class XorshiftVictimManager;
+class Cache;
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : Memory
+*    Application        : Simulates memory
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+
+class Memory
+{
+private:
+    //backed: sparse pages allocated on first write; else reads give zeros and writes vanish
+    bool backed;
+    std::unordered_map<addr_t, uint*> pages;    //page number -> C_MEM_PAGE_WORDS words
+    std::vector<uint*> slabs;                   //pooled page storage, C_MEM_SLAB pages each
+    uint slabUsed = C_MEM_SLAB;                 //pages handed out of the newest slab
+
+    //page holding <addr>, NULL if it was never written and <create> is false
+    uint* getPage(addr_t addr, bool create);
+public:
+    Memory(bool backed = false);
+    ~Memory();
+
+    //reads <wordCount> words from memory into buffer[]
+    void read(addr_t addr, uint* buffer, uint wordCount = 1);
+    void write(addr_t addr, uint* buffer, uint wordCount = 1);
+
+    bool isBacked()  {return backed;}
+    size_t getPages()  {return pages.size();}
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : CacheBlock
+*    Application        : Used to represent a block of data in a cache
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class CacheBlock
+{
+private:
+    bool   dirty = false;    //any writes to block?
+    bool   valid = false;    //any reads into block?
+    
+    int    blockSize;
+    uint*  data = NULL;      //stores data of the cacheBlock
+
+    //sectored blocks: one tag, valid/dirty bits per sector
+    uint   sectorSize = 0;               //words per sector, 0 when not sectored
+    unsigned long long sectorValid = 0;  //bit per sector present
+    unsigned long long sectorDirty = 0;  //bit per sector written since its fill
+
+    //gets offset from an address
+    uint getOffset(addr_t addr);
+public:
+    //constructor: inits data
+    CacheBlock(int blockSize);
+    ~CacheBlock();
+    
+    //getters and setters
+    bool isValid();
+    bool isDirty();
+
+    //marks the block invalid and clean, before it is refilled
+    void reset();
+
+    //splits the block into sectors of <words> words (at most 64 sectors)
+    void setSectorSize(uint words);
+    //sectors covered by <count> words at <address>
+    unsigned long long getSectorMask(addr_t address, uint count);
+    unsigned long long getValidSectors()  {return sectorValid;}
+    unsigned long long getDirtySectors()  {return sectorDirty;}
+    //fills <count> words at <address> from memory, leaving them clean
+    void load(addr_t address, uint* data, uint count);
+
+    //writes <count> words into <data> from this block given the address
+    void write(addr_t address, uint* data, uint count = 1);
+    void read(addr_t address, uint* data, uint count = 1);
+};
+
+//adds doubly-linked-list functionality to CacheBlock
+typedef struct BlockNodest
+{
+    CacheBlock*          block = NULL;
+    int                  way   = 0;     //slot in the set's tag array, never changes
+    struct BlockNodest*  prev  = NULL;
+    struct BlockNodest*  next  = NULL;
+}  BlockNode;
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : Set
+*    Application        : Used to represent a set of blocks
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class Set
+{
+private:
+    BlockNode*  head;       //head pointer of linked list of cache blocks
+    int         size;       //size is number of blocks in the set
+    int         repPolicy;  //repPolicy is to identify replacement policy
+    int         blockSize; 
+    int         validBlocks = 0; //number of valid blocks in this set
+
+    //lengths of these fields in bits
+    int offsetLength;
+    int indexLength;
+    int tagLength;
+    int tagShift;       //offset+index, or just offset when tags hold the whole block address
+    addr_t tagMask;
+    addr_t addrMask;    //address bits kept, the rest alias (as writeBack() rebuilds them)
+
+    //tags by way, packed at the narrowest width that holds tagLength bits
+    int tagWidth;   //16, 32 or 64
+    union
+    {
+        uint16_t*  t16;
+        uint32_t*  t32;
+        addr_t*    t64;
+    }  tags;
+
+    BlockNode** ways;   //way index -> node
+    uint* buffer;       //one block of scratch space for fills and writebacks
+    uint sectorSize = 0;    //words per sector, 0 when not sectored
+
+    //C_CRP_XORSHIFT: the owning cache's generator, and whether invalid ways go first
+    unsigned long long* randomState = NULL;
+    bool preferInvalid = false;
+    //index of this set
+    int index;
+    
+    //reference to memory, and a victim manager
+    Memory* memReference;
+    VictimManager* vicMan = NULL;
+
+    //get tag from address
+    addr_t getTag(addr_t addr);
+    addr_t getWayTag(int way);
+    void setWayTag(int way, addr_t tag);
+    //finds the valid block holding <tag>, NULL on a miss
+    BlockNode* lookup(addr_t tag);
+    //reflects block access in PLRU/LRU/others
+    void reflectBlockAccess(BlockNode* blockPtr);
+    //fetches the block of <address> over the victim, returns the miss kind
+    int fill(addr_t address, BlockNode*& filled);
+    //writes back a victim block
+    void writeBack(BlockNode* victimPtr);
+    //first word of <address>'s block as memory sees it: masked to the simulated width first, as
+    //writeBack() rebuilds it, so every refill path reads where the block is written back
+    addr_t getBlockBase(addr_t address)  {return ((address & addrMask) / blockSize) * blockSize;}
+    //refetches <victimPtr> with the block of <address>
+    void refill(BlockNode* victimPtr, addr_t address);
+    //fetches the sectors of <count> words at <address> that <blockPtr> lacks, true if any
+    bool fetchSectors(BlockNode* blockPtr, addr_t address, uint count);
+
+    //way-level access for skewed indexing, where a block may only live in one way of the set
+    BlockNode* probeWay(int way, addr_t address);
+    int fillWay(int way, addr_t address, BlockNode*& filled);
+
+public:
+    //constructor: many functions
+    //blockTags: tags keep the whole block address, for index functions that are not bit selects
+    Set(Memory* mR, int index, int numSets, int setSize, int blockSize, int repPolicy, int addrBits,
+        bool blockTags = false);
+    ~Set();
+
+    int getValidBlocks()  {return validBlocks;}
+    //splits every block into sectors of <words> words
+    void setSectorSize(uint words);
+
+    //memory traffic, in words, and what whole-block transfers would have moved
+    unsigned long long stat_words_fetched = 0;
+    unsigned long long stat_words_written = 0;
+    unsigned long long stat_block_fills = 0;
+    unsigned long long stat_block_writebacks = 0;
+    unsigned long long stat_sector_misses = 0;  //tag present, sector not
+
+    //read <count> words from address into <data[]>
+    int read(addr_t address, uint* data, uint count = 1);
+    int write(addr_t address, uint* data, uint count = 1);
+
+    //friends since they access the Blocks LinkedList
+    friend class Cache;
+    friend class VictimManager;
+    friend class RandomVictimManager;
+    friend class LRUVictimManager;
+    friend class TreeVictimManager;
+    friend class XorshiftVictimManager;
+};
+
+//one decoded trace record, as fed to Cache::access()
+typedef struct Accessst
+{
+    addr_t  address = 0;
+    uint  size    = 1;      //words touched from <address> on, may straddle blocks
+    bool  write   = false;
+    bool  fetch   = false;  //instruction fetch, goes to the I-cache
+    bool  walk    = false;  //page-table read issued by the Mmu
+    addr_t  pc    = 0;      //instruction that issued it, 0 if the trace does not say
+}  Access;
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : Cache
+*    Application        : Used to represent the cache
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//counters of a Cache, one per S_* slot; plain integers, so the hot path only adds to them
+typedef struct CacheStatsst
+{
+    long long accesses = 0;
+    long long reads = 0;
+    long long writes = 0;
+    long long misses = 0;           //counted per block access
+    long long compulsory = 0;
+    long long capacity = 0;
+    long long conflict = 0;
+    long long readMisses = 0;
+    long long writeMisses = 0;
+    long long dirtyEvictions = 0;
+    long long blockAccesses = 0;    //accesses counted once per block touched
+}  CacheStats;
+
+//registry entry: what a CacheStats counter is called and measures, for exports
+typedef struct StatDefst
+{
+    const char*  name;          //stable snake_case key
+    const char*  description;
+    const char*  unit;
+    long long CacheStatsst::*  field;
+}  StatDef;
+
+//CacheStats counters by S_* slot
+extern const StatDef cacheStatDefs[S_COUNT];
+
+//one exported value of any model, named like the registry's
+typedef struct StatValuest
+{
+    std::string  name;
+    std::string  value;     //as written: integers exactly, ratios as the text reports print them;
+                            //empty for a ratio with nothing to divide by (nan or inf)
+    const char*  unit;
+    const char*  description;
+}  StatValue;
+
+//a named group of exported values, e.g. "l1" or "timing" (see writeStats)
+typedef struct StatGroupst
+{
+    std::string  name;
+    std::vector<StatValue>  values;
+
+    StatGroupst(const std::string& name = "") : name(name)  {}
+}  StatGroup;
+
+void addStat(StatGroup& group, const std::string& name, long long value, const char* unit,
+             const char* description);
+void addStat(StatGroup& group, const std::string& name, double value, const char* unit,
+             const char* description);
+//the S_COUNT counters of values[], by cacheStatDefs
+void addCacheStats(StatGroup& group, const long long* values);
+
+//counters of one call into a Cache, added to its stat fields once at the end
+typedef struct AccessCountsst
+{
+    int reads = 0, writes = 0, skipped = 0;
+    int blocks = 0;     //block accesses the reads and writes split into
+    int misses = 0, missReads = 0, missWrites = 0;
+    int compulsory = 0, capacity = 0, conflict = 0, dirtyEvicted = 0;
+}  AccessCounts;
+
+class Cache
+{
+private:
+    int numSets;   //number of sets in the cache
+    int numWays;    //number of ways in the cache
+    int numBlocks;  //number of blocks in the cache
+
+    int cacheSize;  //size of the cache (words)
+    int blockSize;  //size of the cache block (words)
+
+    //length of the offset field in bits in an address
+    int offsetLength;
+    int indexLength;
+    
+    int repPolicy;  //replacement policy
+    Set** sets;     //pointer to represent sets
+
+    //set index function
+    int indexFunc;
+    addr_t blockMask;       //block address bits within the address width
+    uint primeSets;         //sets in use under C_IDX_PRIME
+    unsigned long long* skewStamp = NULL;  //last use of each line under C_IDX_SKEW, by set*ways+way
+    unsigned long long skewClock = 0;
+    uint skewVictim = 0;    //round-robin way for skewed random replacement
+
+    //generator behind C_CRP_XORSHIFT, shared by all sets
+    unsigned long long randomState = seedRandom(1);
+
+    //index of the block of <address> in way <way> under C_IDX_SKEW
+    uint getSkewIndex(addr_t address, int way);
+    //looks up/fills the block of <address> across the skewed ways, returns the C_HIT/C_MISS_* outcome
+    int skewAccess(addr_t address, bool write, uint* buffer, uint count, uint& index);
+    //dispatches one access to the set (or ways) holding <address>, whose index is left in <index>
+    int lookupAccess(addr_t address, bool write, uint* buffer, uint count, uint& index);
+    //runs all <size> words from <address> through each block they touch, a piece at a time, and
+    //returns the worst outcome of the pieces; buffer NULL: data goes through <scratch> and is
+    //discarded (or checked)
+    int splitAccess(addr_t address, uint size, bool write, uint* buffer, AccessCounts& counts);
+    //adds <counts> into the stat fields
+    void flush(const AccessCounts& counts);
+    //sector traffic summed over the sets, for reportTraffic and exportTraffic
+    void sumTraffic(unsigned long long& fetched, unsigned long long& written, unsigned long long& fills,
+                    unsigned long long& writebacks, unsigned long long& sectorMisses);
+
+    //one block of data for accesses whose data is discarded, and of data-check values
+    uint* scratch;
+    uint* expected;
+
+    //data check: every write also goes to <checkRef>, every read is compared against it
+    Memory* checkRef = NULL;
+    addr_t addrMask;        //address bits the cache keeps, for the shadow copy
+    uint nextValue = 1;     //value of the next checked write
+
+    //per-set counters, NULL unless enabled
+    unsigned long long* setStats = NULL;
+    void countSet(uint index, int hitstatus);
+
+    //banking, only consulted by the timing model
+    uint numBanks = 1;
+    uint bankShift = 0;     //lowest address bit of the bank field
+    int  bankHash = C_BANK_BITS;
+
+    //stores the accessed addresses from cache
+    //useful to determine compulsory misses
+    std::set<addr_t, std::greater<addr_t>> stat_addr_queried;
+public:
+    //addrBits: width of the simulated addresses, at most C_ADDR_LEN
+    //indexFunc: one of C_IDX_*, maps a block address onto a set
+    Cache(Memory* mR, int cacheSize, int blockSize, int org, int repPolicy, int addrBits = C_ADDR_BITS,
+          int indexFunc = C_IDX_MODULO);
+    ~Cache();
+
+    //read <count> words from <address> into <buffer[]>; the words may span several blocks
+    void read(addr_t address, uint* buffer, uint count = 1);
+    void write(addr_t address, uint* buffer, uint count = 1);
+
+    //processes <count> accesses in one go; stats are accumulated locally
+    //and flushed once per batch, data read is discarded
+    //only accesses whose fetch flag equals <fetch> are simulated, the rest are skipped
+    //status[], if given, receives the C_HIT/C_MISS_*/C_SKIPPED outcome of each access
+    void access(const Access* accesses, uint count, bool fetch = false, unsigned char* status = NULL);
+
+    //functional warming: updates tag and replacement state only, no stats
+    void warm(const Access& access);
+
+    //gets an index from an address (way 0's under C_IDX_SKEW)
+    uint getIndex(addr_t address);
+    int getNumSets()  {return numSets;}
+    int getBlockSize()  {return blockSize;}
+
+    //prints how many sets hold each number of valid blocks, and the fullest sets
+    void reportOccupancy(std::ostream& out, const char* prefix);
+
+    //C_CRP_XORSHIFT: reseeds the generator; preferInvalid fills invalid ways before evicting
+    void setRandom(unsigned long long seed, bool preferInvalid);
+
+    //access() writes distinct values and checks every read against <shadow>, a backed Memory
+    //kept beside the cache's own; the cache's Memory must be backed too
+    void setDataCheck(Memory* shadow)  {checkRef = shadow;}
+    unsigned long long stat_data_mismatch = 0;
+
+    //counts accesses, misses, evictions and dirty evictions per set (C_SET_* slots)
+    void enableSetStats();
+    //prints the <top> hottest sets and how sets spread around the mean access count
+    void reportSets(std::ostream& out, const char* prefix, uint top);
+    //one CSV row per set
+    void writeSetCsv(std::ostream& out);
+
+    //sectors of <words> words (a power of 2 dividing the block, at most 64 per block)
+    //with their own valid and dirty bits; only touched sectors are fetched or written back
+    void setSectorSize(uint words);
+    //prints memory traffic against what whole-block fills and writebacks would move
+    void reportTraffic(std::ostream& out, const char* prefix);
+    void exportTraffic(StatGroup& group);
+
+    //splits the cache into <numBanks> (a power of 2) banks selected from address bit <shift> up
+    void setBanks(uint numBanks, uint shift, int hash);
+    uint getBank(addr_t address);
+    uint getNumBanks()  {return numBanks;}
+
+    //copies the stats into values[S_COUNT], indexed by the S_* slots
+    void snapshot(long long* values);
+
+    //statistics
+    CacheStats stats;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef CACHEMAN_H
+#define CACHEMAN_H
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Public C++ API of the cacheman library, every header in one; link libcacheman.a
+*               (see build.sh). C callers use cacheman_c.h instead
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+#include "cache.h"
+#include "policy.h"
+#include "stats.h"
+#include "timing.h"
+#include "mmu.h"
+#include "trace.h"
+#include "server.h"
+#include "perf.h"
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef CACHEMAN_C_H
+#define CACHEMAN_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : C ABI of the cacheman library: one simulated cache per handle, driven by batches
+*               of accesses from the caller's own process, no trace file involved
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CACHEMAN_ABI_VERSION 1  /* bumped on any incompatible change below */
+
+#define CACHEMAN_REF_SIZE_MAX 1024  /* largest cacheman_ref size, one 4 KiB page of words */
+
+/* Return codes */
+#define CACHEMAN_OK      0
+#define CACHEMAN_EINVAL -1  /* NULL handle, unknown option or value out of range */
+#define CACHEMAN_EBUSY  -2  /* option can only be changed before the first access */
+
+/* Replacement policies (C_CRP_*) */
+#define CACHEMAN_POLICY_RANDOM   0
+#define CACHEMAN_POLICY_LRU      1
+#define CACHEMAN_POLICY_TREE     2
+#define CACHEMAN_POLICY_XORSHIFT 3
+
+/* Set index functions (C_IDX_*) */
+#define CACHEMAN_INDEX_MODULO 0
+#define CACHEMAN_INDEX_XOR    1
+#define CACHEMAN_INDEX_PRIME  2
+#define CACHEMAN_INDEX_SKEW   3
+
+/* Options for cacheman_configure() */
+#define CACHEMAN_OPT_ADDR_BITS      1   /* simulated address width, above log2(block size) and up to
+                                               64 (default 48); before access */
+#define CACHEMAN_OPT_INDEX          2   /* CACHEMAN_INDEX_*; before access */
+#define CACHEMAN_OPT_SECTOR         3   /* words per sector, 0 for whole blocks; before access */
+#define CACHEMAN_OPT_RANDOM_SEED    4   /* reseeds CACHEMAN_POLICY_XORSHIFT */
+#define CACHEMAN_OPT_RANDOM_INVALID 5   /* 1: CACHEMAN_POLICY_XORSHIFT fills invalid ways first */
+
+/* Per-access outcomes written by cacheman_access() (C_HIT, C_MISS_*) */
+#define CACHEMAN_HIT          0
+#define CACHEMAN_MISS_INVALID 1     /* filled an invalid way */
+#define CACHEMAN_MISS_CLEAN   2     /* evicted a clean block */
+#define CACHEMAN_MISS_DIRTY   3     /* evicted a dirty block, written back */
+
+typedef struct cacheman_cache cacheman_cache;
+
+/* one memory reference */
+typedef struct cacheman_ref
+{
+    uint64_t  address;
+    uint32_t  size;     /* words from address on, may straddle blocks; 0 counts as 1, at most
+                           CACHEMAN_REF_SIZE_MAX */
+    uint32_t  write;    /* non-zero for a write */
+}  cacheman_ref;
+
+/* Totals, as the cacheman CLI prints them; fields are only ever appended */
+typedef struct cacheman_stats
+{
+    uint64_t  accesses;
+    uint64_t  reads;
+    uint64_t  writes;
+    uint64_t  misses;           /* per block touched */
+    uint64_t  compulsory;
+    uint64_t  capacity;         /* fully associative caches only */
+    uint64_t  conflict;
+    uint64_t  read_misses;
+    uint64_t  write_misses;
+    uint64_t  dirty_evictions;
+    uint64_t  block_accesses;   /* accesses counted once per block touched */
+}  cacheman_stats;
+
+/* CACHEMAN_ABI_VERSION of the library actually linked */
+int cacheman_abi_version(void);
+
+/* a cache of <cache_size> words in blocks of <block_size> words (both powers of 2), <assoc> ways
+   (a power of 2, 0 for fully associative) and a CACHEMAN_POLICY_*; NULL on a bad geometry */
+cacheman_cache* cacheman_create(uint32_t cache_size, uint32_t block_size, uint32_t assoc, int policy);
+
+/* sets a CACHEMAN_OPT_* option; returns CACHEMAN_OK or a negative CACHEMAN_E* code */
+int cacheman_configure(cacheman_cache* cache, int option, uint64_t value);
+
+/* simulates <count> accesses in order; status, if not NULL, receives a CACHEMAN_HIT/MISS_*
+   per access (the worst of the blocks it touched); CACHEMAN_EINVAL, with nothing simulated, if
+   any size is over CACHEMAN_REF_SIZE_MAX */
+int cacheman_access(cacheman_cache* cache, const cacheman_ref* accesses, uint32_t count,
+                    uint8_t* status);
+
+/* copies the first <size> bytes of the totals into <stats>; pass sizeof(cacheman_stats), older
+   callers keep working when fields are appended */
+int cacheman_get_stats(const cacheman_cache* cache, cacheman_stats* stats, size_t size);
+
+void cacheman_destroy(cacheman_cache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+#include "cacheman_c.h"
+#include "cache.h"
+
+#include <cstring>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : C ABI over Cache (see cacheman_c.h)
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//the handle: a Cache, its memory, and what is needed to rebuild it
+struct cacheman_cache
+{
+    int cacheSize;
+    int blockSize;
+    int assoc;
+    int policy;
+
+    //options applied to every rebuilt Cache
+    int addrBits = C_ADDR_BITS;
+    int indexFunc = C_IDX_MODULO;
+    uint sectorSize = 0;
+    unsigned long long randomSeed = 1;
+    bool randomInvalid = false;
+
+    Memory memory;
+    Cache* cache = NULL;
+    Access* batch = NULL;   //C_BATCH_SIZE accesses converted at a time
+};
+
+static bool isPow2(uint64_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+//(re)builds the Cache of <handle> from its geometry and options
+static void build(cacheman_cache* handle)
+{
+    delete handle->cache;
+    handle->cache = new Cache(&handle->memory, handle->cacheSize, handle->blockSize, handle->assoc,
+                              handle->policy, handle->addrBits, handle->indexFunc);
+    handle->cache->setRandom(handle->randomSeed, handle->randomInvalid);
+    if(handle->sectorSize > 0)  {
+        handle->cache->setSectorSize(handle->sectorSize);
+    }
+}
+
+extern "C" int cacheman_abi_version(void)
+{
+    return CACHEMAN_ABI_VERSION;
+}
+
+extern "C" cacheman_cache* cacheman_create(uint32_t cache_size, uint32_t block_size, uint32_t assoc, int policy)
+{
+    if(!isPow2(cache_size) || !isPow2(block_size) || block_size > cache_size ||
+       cache_size > (1u << 30))  {
+        return NULL;
+    }
+    if(assoc != 0 && (!isPow2(assoc) || assoc > cache_size / block_size))  {
+        return NULL;
+    }
+    if(policy < C_CRP_RANDOM || policy > C_CRP_XORSHIFT)  {
+        return NULL;
+    }
+
+    cacheman_cache* handle = new cacheman_cache();
+    handle->cacheSize = cache_size;
+    handle->blockSize = block_size;
+    handle->assoc = assoc;
+    handle->policy = policy;
+    handle->batch = new Access[C_BATCH_SIZE];
+    build(handle);
+    return handle;
+}
+
+extern "C" int cacheman_configure(cacheman_cache* cache, int option, uint64_t value)
+{
+    if(cache == NULL)  {
+        return CACHEMAN_EINVAL;
+    }
+
+    //options that shape the sets need a fresh Cache, so they are refused once it has state
+    bool fresh = (cache->cache->stats.accesses == 0);
+
+    if(option == CACHEMAN_OPT_ADDR_BITS)
+    {
+        if(value <= (uint64_t) log2(cache->blockSize) || value > C_ADDR_LEN)  {return CACHEMAN_EINVAL;}
+        if(!fresh)                           {return CACHEMAN_EBUSY;}
+        cache->addrBits = (int) value;
+        build(cache);
+    }
+    else if(option == CACHEMAN_OPT_INDEX)
+    {
+        if(value > C_IDX_SKEW)  {return CACHEMAN_EINVAL;}
+        if(!fresh)              {return CACHEMAN_EBUSY;}
+        cache->indexFunc = (int) value;
+        build(cache);
+    }
+    else if(option == CACHEMAN_OPT_SECTOR)
+    {
+        //same rule as --sector
+        if(value != 0 && (!isPow2(value) || cache->blockSize % value != 0 || cache->blockSize / value > 64))  {
+            return CACHEMAN_EINVAL;
+        }
+        if(!fresh)  {return CACHEMAN_EBUSY;}
+        cache->sectorSize = (uint) value;
+        build(cache);
+    }
+    else if(option == CACHEMAN_OPT_RANDOM_SEED)
+    {
+        cache->randomSeed = value;
+        cache->cache->setRandom(cache->randomSeed, cache->randomInvalid);
+    }
+    else if(option == CACHEMAN_OPT_RANDOM_INVALID)
+    {
+        //reseeds too: setRandom() sets both
+        cache->randomInvalid = (value != 0);
+        cache->cache->setRandom(cache->randomSeed, cache->randomInvalid);
+    }
+    else  {
+        return CACHEMAN_EINVAL;
+    }
+
+    return CACHEMAN_OK;
+}
+
+extern "C" int cacheman_access(cacheman_cache* cache, const cacheman_ref* accesses, uint32_t count,
+                               uint8_t* status)
+{
+    if(cache == NULL || (accesses == NULL && count > 0))  {
+        return CACHEMAN_EINVAL;
+    }
+    for(uint32_t i = 0; i < count; i++)  {
+        if(accesses[i].size > CACHEMAN_REF_SIZE_MAX)  {
+            return CACHEMAN_EINVAL;
+        }
+    }
+
+    while(count > 0)
+    {
+        uint run = (count < C_BATCH_SIZE) ? count : C_BATCH_SIZE;
+        for(uint i = 0; i < run; i++)
+        {
+            cache->batch[i].address = accesses[i].address;
+            cache->batch[i].size = accesses[i].size;
+            cache->batch[i].write = (accesses[i].write != 0);
+        }
+
+        cache->cache->access(cache->batch, run, false, status);
+
+        accesses += run;
+        if(status != NULL)  {
+            status += run;
+        }
+        count -= run;
+    }
+
+    return CACHEMAN_OK;
+}
+
+extern "C" int cacheman_get_stats(const cacheman_cache* cache, cacheman_stats* stats, size_t size)
+{
+    if(cache == NULL || stats == NULL)  {
+        return CACHEMAN_EINVAL;
+    }
+
+    const Cache* c = cache->cache;
+    cacheman_stats all;
+    all.accesses = c->stats.accesses;
+    all.reads = c->stats.reads;
+    all.writes = c->stats.writes;
+    all.misses = c->stats.misses;
+    all.compulsory = c->stats.compulsory;
+    all.capacity = (cache->assoc == 0) ? c->stats.capacity : 0;    //as main() prints it
+    all.conflict = c->stats.conflict;
+    all.read_misses = c->stats.readMisses;
+    all.write_misses = c->stats.writeMisses;
+    all.dirty_evictions = c->stats.dirtyEvictions;
+    all.block_accesses = c->stats.blockAccesses;
+
+    memcpy(stats, &all, (size < sizeof(all)) ? size : sizeof(all));
+    return CACHEMAN_OK;
+}
+
+extern "C" void cacheman_destroy(cacheman_cache* cache)
+{
+    if(cache == NULL)  {
+        return;
+    }
+    delete cache->cache;
+    delete[] cache->batch;
+    delete cache;
+}
@@ -0,0 +1,919 @@
+#include "cacheman.h"
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Command line front end of the cache simulator
+*    Question : CS2610 A6
+*    Build    : build.sh, linked against libcacheman.a
+-------------------------------------------------------------------------------------------------*/
+
+//the limits capi.cpp and server.cpp apply: powers of 2, block within the cache, at most 2^30
+//words, assoc 0 (fully associative) or a power of 2 up to the blocks in the cache, a C_CRP_* policy
+static bool checkGeometry(const char* what, int cacheSize, int blockSize, int assoc, int policy, int addrBits)
+{
+    bool ok = cacheSize > 0 && blockSize > 0 && (cacheSize & (cacheSize - 1)) == 0 &&
+              (blockSize & (blockSize - 1)) == 0 && blockSize <= cacheSize && cacheSize <= (1 << 30) &&
+              (assoc == 0 || (assoc > 0 && (assoc & (assoc - 1)) == 0 && assoc <= cacheSize / blockSize)) &&
+              policy >= C_CRP_RANDOM && policy <= C_CRP_XORSHIFT;
+    if(!ok)  {
+        std::cerr << what << ": size and block size must be powers of 2 (block <= size <= 2^30), assoc 0 "
+                  << "or a power of 2 up to size/block, policy " << C_CRP_RANDOM << " to " << C_CRP_XORSHIFT << std::endl;
+        return false;
+    }
+
+    //an address must reach past the block offset
+    if(addrBits <= log2(blockSize) || addrBits > C_ADDR_LEN)  {
+        std::cerr << what << ": --addr-bits must be above log2 of the block size (" << log2(blockSize)
+                  << ") and at most " << C_ADDR_LEN << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//sets index with a mask and tree PLRU halves the ways, so both are powers of 2
+static bool checkTlb(const char* what, uint sets, uint ways, int policy)
+{
+    bool ok = sets > 0 && (sets & (sets - 1)) == 0 && ways > 0 &&
+              (policy != C_CRP_TREE || (ways & (ways - 1)) == 0) &&
+              policy >= C_CRP_RANDOM && policy <= C_CRP_XORSHIFT;
+    if(!ok)  {
+        std::cerr << what << ": sets must be a power of 2, ways at least 1 (a power of 2 for tree PLRU), "
+                  << "policy " << C_CRP_RANDOM << " to " << C_CRP_XORSHIFT << std::endl;
+    }
+    return ok;
+}
+
+/*-------------------------------------------------------------------------------------------------
+*    Function Name : main
+*    Args          : optional flags
+*                       --trace F           trace file, "-" for stdin or a named pipe; the cache
+*                                           parameters then come from the flags below instead of
+*                                           stdin
+*                       --cache-size N      cache size (words)
+*                       --block-size N      block size (words)
+*                       --assoc N           associativity, 0 for fully associative
+*                       --policy N          replacement policy (C_CRP_*)
+*                       --random-seed S     seed of the C_CRP_XORSHIFT generators (default 1)
+*                       --random-invalid B  1: C_CRP_XORSHIFT fills invalid ways before evicting
+*                       --addr-bits N       simulated address width, above log2 of the block size and
+*                                           up to 64 (default 48)
+*                       --interval N        print stat deltas every N accesses
+*                       --interval-format F text (default), csv or binary
+*                       --interval-out F    file for the interval series (default stdout)
+*                       --progress S        every S seconds, print the share of the trace done,
+*                                           accesses/s, ETA and RSS to stderr
+*                       --progress-file F   rewrite the same as JSON into F every S (default 10)
+*                                           seconds, e.g. for a job scheduler
+*                       --index F           L1 set index function: modulo (default), xor, prime or
+*                                           skew; also reports the per-set occupancy
+*                       --reuse M           reuse-distance histogram of the data accesses, M global
+*                                           or set (adds one per L1 set)
+*                       --set-stats N       count accesses, misses and evictions per L1 set and list
+*                                           the N hottest sets with a utilization histogram
+*                       --set-csv F         write those per-set counters to F as CSV
+*                       --stats-format S    totals as text (bare numbers, default), json, csv or a
+*                                           table, each counter with its name, unit and description
+*                       --stats-out F       write a json/csv/table dump to F instead of stdout; on
+*                                           stdout the dump is all there is, and the banner and
+*                                           the other reports go to stderr
+*                       --pc-stats N        attribute L1 hits, misses and dirty evictions to the pc of
+*                                           each access and list the N worst pcs
+*                       --backed-memory B   1: keep real data in a sparse memory (default tag-only)
+*                       --check-data B      1: write distinct values through the L1 and check every
+*                                           read against a shadow memory (implies backed memory)
+*                       --sector N          sectored L1 with N-word sectors, fetched and written
+*                                           back on their own; reports the traffic saved
+*                       --timing H,M,K[,G]  time the L1: hit latency, miss latency, MSHRs and
+*                                           cycles between accesses (default 1)
+*                       --itiming H,M,K[,G] same for the I-cache
+*                       --mem-bw N          words per cycle on the shared memory channel
+*                       --banks N[,S[,xor]] split the L1 into N banks selected from address bit S
+*                                           (default: just above the block offset)
+*                       --bank-busy C       cycles an access holds its L1 bank (timing, default 1)
+*                       --ports P           L1 accesses issued per cycle (timing, default 1)
+*                       --tlb S,W,P         L1 TLB: sets, ways, replacement policy (C_CRP_*)
+*                       --stlb S,W,P        second-level TLB behind it
+*                       --page-size Z[@A-B] page size 4K, 2M or 1G; with a hex range [A, B) it
+*                                           applies there only, else it is the default
+*                       --sample-period N   sample one window every N accesses (0: full simulation)
+*                       --sample-window N   measured accesses per window (default 1000)
+*                       --sample-warmup N   detailed but unmeasured accesses before each window
+*                       --sample-error E    target relative error on the miss ratio (default 0.05)
+*                       --format F          trace format: auto (default), text, binary, lackey,
+*                                           din or champsim
+*                       --generate P        synthetic trace instead of --trace: sequential, strided,
+*                                           random, zipf, chase or mixed (cache flags as for --trace)
+*                       --gen-length N      accesses generated (default 1000000)
+*                       --gen-seed S        generator seed (default 1)
+*                       --gen-footprint W   words spanned (default 1M), from --gen-base (hex)
+*                       --gen-stride W      words between strided accesses, zipf items, chase nodes
+*                       --gen-writes P      percent of accesses that write (default 30)
+*                       --gen-skew S        zipf exponent (default 0.99)
+*                       --gen-out F         write the generated trace to F in the binary format and
+*                                           exit, without simulating
+*                       --icache S,B,A,P    I-cache (size, block size, assoc, policy) for the
+*                                           instruction fetches; without it they are dropped
+*                       --host-profile B    1: count host cycles, instructions, LLC and branch misses
+*                                           per phase of the run (perf_event_open, Linux) and
+*                                           report host cycles per simulated access
+*                       --serve P           run as a daemon on the Unix socket P, keeping caches
+*                                           resident for clients (see server.h), until SIGINT/SIGTERM
+*    Return Type   : int(0)
+*    Application   : Entry point to the Proram
+-------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    //parameters required to define the cache, -1 until given
+    int cacheSize = -1, blockSize = -1, org = -1, repPolicy = -1;
+    std::string filename;
+
+    int addrBits = C_ADDR_BITS;
+    unsigned long long randomSeed = 1;
+    bool randomInvalid = false;
+    unsigned long long interval = 0;
+    int seriesFormat = C_SERIES_TEXT;
+    std::string seriesPath = "-";
+    int indexFunc = C_IDX_MODULO;
+    bool indexGiven = false;
+    uint sectorSize = 0;
+    bool backedMemory = false, checkData = false;
+    bool reuse = false, reusePerSet = false;
+    bool setStats = false;
+    uint pcTop = 0;     //0: no per-pc stats
+    uint hotSets = C_TOP_SETS;
+    std::string setCsv;
+    int statsFormat = C_STATS_TEXT;
+    std::string statsPath = "-";
+    bool hostProfile = false;
+    double progressPeriod = 0;  //0: no progress lines
+    std::string progressPath;
+
+    //sampling parameters, see header
+    uint samplePeriod = 0;
+    uint sampleWindow = 1000;
+    uint sampleWarmup = 0;
+    double sampleError = 0.05;
+
+    int traceFormat = C_TRAC_AUTO;
+
+    //synthetic trace, instead of a file
+    bool generate = false;
+    GeneratorConfig genConfig;
+    std::string genOut;
+
+    //daemon mode, socket path
+    std::string servePath;
+
+    //I-cache parameters, size 0 for none
+    int iCacheSize = 0, iBlockSize = 0, iOrg = 0, iRepPolicy = 0;
+
+    //timing layer, off unless configured
+    bool timing = false, iTiming = false;
+    TimingConfig timingConfig, iTimingConfig;
+    uint memBandwidth = 4;
+
+    //banking
+    uint numBanks = 1, bankShift = 0, bankBusy = 1, ports = 1;
+    int bankHash = C_BANK_BITS;
+    bool bankShiftGiven = false;
+
+    //TLBs, 0 sets for none
+    uint tlbSets = 0, tlbWays = 0, stlbSets = 0, stlbWays = 0;
+    int tlbPolicy = C_CRP_LRU, stlbPolicy = C_CRP_LRU;
+    uint pageShift = C_PAGE_4K;
+    std::vector<PageRange> pageRanges;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string flag = argv[i];
+        if(i + 1 >= argc)  {
+            std::cerr << "missing value for " << flag << std::endl;
+            return 1;
+        }
+
+        if(flag == "--trace")               {filename = argv[++i];}
+        else if(flag == "--cache-size")     {cacheSize = std::atoi(argv[++i]);}
+        else if(flag == "--block-size")     {blockSize = std::atoi(argv[++i]);}
+        else if(flag == "--assoc")          {org = std::atoi(argv[++i]);}
+        else if(flag == "--policy")         {repPolicy = std::atoi(argv[++i]);}
+        else if(flag == "--random-seed")    {randomSeed = std::strtoull(argv[++i], NULL, 10);}
+        else if(flag == "--random-invalid") {randomInvalid = std::atoi(argv[++i]) != 0;}
+        else if(flag == "--icache")
+        {
+            if(sscanf(argv[++i], "%d,%d,%d,%d", &iCacheSize, &iBlockSize, &iOrg, &iRepPolicy) != 4 ||
+               iCacheSize <= 0 || iBlockSize <= 0)  {
+                std::cerr << "--icache expects size,block,assoc,policy" << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--addr-bits")
+        {
+            addrBits = std::atoi(argv[++i]);
+            if(addrBits < 1 || addrBits > C_ADDR_LEN)  {
+                std::cerr << "--addr-bits must be between 1 and " << C_ADDR_LEN << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--timing" || flag == "--itiming")
+        {
+            TimingConfig& config = (flag == "--timing") ? timingConfig : iTimingConfig;
+            int got = sscanf(argv[++i], "%u,%u,%u,%u", &config.hitLatency, &config.missLatency,
+                             &config.mshrs, &config.issueGap);
+            if(got < 3)  {
+                std::cerr << flag << " expects hit,miss,mshrs[,gap]" << std::endl;
+                return 1;
+            }
+            if(flag == "--timing")  {timing = true;}
+            else                    {iTiming = true;}
+        }
+        else if(flag == "--banks")
+        {
+            char hash[8] = "";
+            int got = sscanf(argv[++i], "%u,%u,%7s", &numBanks, &bankShift, hash);
+            if(got < 1 || numBanks == 0 || (numBanks & (numBanks - 1)) != 0)  {
+                std::cerr << "--banks expects a power of 2, then optionally ,shift[,xor]" << std::endl;
+                return 1;
+            }
+            bankShiftGiven = (got >= 2);
+            bankHash = (std::string(hash) == "xor") ? C_BANK_XOR : C_BANK_BITS;
+        }
+        else if(flag == "--tlb" || flag == "--stlb")
+        {
+            bool first = (flag == "--tlb");
+            if(sscanf(argv[++i], "%u,%u,%d", first ? &tlbSets : &stlbSets, first ? &tlbWays : &stlbWays,
+                      first ? &tlbPolicy : &stlbPolicy) != 3)  {
+                std::cerr << flag << " expects sets,ways,policy" << std::endl;
+                return 1;
+            }
+            if(!checkTlb(flag.c_str(), first ? tlbSets : stlbSets, first ? tlbWays : stlbWays,
+                         first ? tlbPolicy : stlbPolicy))  {
+                return 1;
+            }
+        }
+        else if(flag == "--page-size")
+        {
+            std::string spec = argv[++i];
+            std::string size = spec.substr(0, spec.find('@'));
+
+            PageRange range;
+            if(size == "4K" || size == "4k")       {range.shift = C_PAGE_4K;}
+            else if(size == "2M" || size == "2m")  {range.shift = C_PAGE_2M;}
+            else if(size == "1G" || size == "1g")  {range.shift = C_PAGE_1G;}
+            else  {
+                std::cerr << "page size must be 4K, 2M or 1G" << std::endl;
+                return 1;
+            }
+
+            if(spec.find('@') == std::string::npos)  {
+                pageShift = range.shift;
+            }
+            else if(sscanf(spec.c_str() + spec.find('@') + 1, "%llx-%llx", &range.start, &range.end) == 2)  {
+                pageRanges.push_back(range);
+            }
+            else  {
+                std::cerr << "page range must be <hex start>-<hex end>" << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--bank-busy")      {bankBusy = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--ports")          {ports = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--mem-bw")         {memBandwidth = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--reuse")
+        {
+            std::string mode = argv[++i];
+            if(mode != "global" && mode != "set")  {
+                std::cerr << "--reuse expects global or set" << std::endl;
+                return 1;
+            }
+            reuse = true;
+            reusePerSet = (mode == "set");
+        }
+        else if(flag == "--set-stats")
+        {
+            setStats = true;
+            hotSets = std::strtoul(argv[++i], NULL, 10);
+        }
+        else if(flag == "--stats-format")
+        {
+            std::string name = argv[++i];
+            if(name == "text")        {statsFormat = C_STATS_TEXT;}
+            else if(name == "json")   {statsFormat = C_STATS_JSON;}
+            else if(name == "csv")    {statsFormat = C_STATS_CSV;}
+            else if(name == "table")  {statsFormat = C_STATS_TABLE;}
+            else  {
+                std::cerr << "unknown stats format " << name << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--stats-out")      {statsPath = argv[++i];}
+        else if(flag == "--set-csv")
+        {
+            setStats = true;
+            setCsv = argv[++i];
+        }
+        else if(flag == "--pc-stats")       {pcTop = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--backed-memory")  {backedMemory = std::atoi(argv[++i]) != 0;}
+        else if(flag == "--check-data")     {checkData = std::atoi(argv[++i]) != 0;}
+        else if(flag == "--host-profile")   {hostProfile = std::atoi(argv[++i]) != 0;}
+        else if(flag == "--sector")         {sectorSize = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--interval")       {interval = std::strtoull(argv[++i], NULL, 10);}
+        else if(flag == "--interval-out")   {seriesPath = argv[++i];}
+        else if(flag == "--progress")       {progressPeriod = std::atof(argv[++i]);}
+        else if(flag == "--progress-file")  {progressPath = argv[++i];}
+        else if(flag == "--interval-format")
+        {
+            std::string name = argv[++i];
+            if(name == "text")          {seriesFormat = C_SERIES_TEXT;}
+            else if(name == "csv")      {seriesFormat = C_SERIES_CSV;}
+            else if(name == "binary")   {seriesFormat = C_SERIES_BIN;}
+            else  {
+                std::cerr << "unknown interval format " << name << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--sample-period")  {samplePeriod = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--sample-window")
+        {
+            sampleWindow = std::strtoul(argv[++i], NULL, 10);
+            if(sampleWindow == 0)  {
+                std::cerr << "--sample-window must be at least 1" << std::endl;
+                return 1;
+            }
+        }
+        else if(flag == "--sample-warmup")  {sampleWarmup = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--sample-error")   {sampleError = std::strtod(argv[++i], NULL);}
+        else if(flag == "--index")
+        {
+            std::string name = argv[++i];
+            if(name == "modulo")      {indexFunc = C_IDX_MODULO;}
+            else if(name == "xor")    {indexFunc = C_IDX_XOR;}
+            else if(name == "prime")  {indexFunc = C_IDX_PRIME;}
+            else if(name == "skew")   {indexFunc = C_IDX_SKEW;}
+            else  {
+                std::cerr << "unknown index function " << name << std::endl;
+                return 1;
+            }
+            indexGiven = true;
+        }
+        else if(flag == "--generate")
+        {
+            std::string name = argv[++i];
+            if(name == "sequential")      {genConfig.pattern = C_GEN_SEQUENTIAL;}
+            else if(name == "strided")    {genConfig.pattern = C_GEN_STRIDED;}
+            else if(name == "random")     {genConfig.pattern = C_GEN_RANDOM;}
+            else if(name == "zipf")       {genConfig.pattern = C_GEN_ZIPF;}
+            else if(name == "chase")      {genConfig.pattern = C_GEN_CHASE;}
+            else if(name == "mixed")      {genConfig.pattern = C_GEN_MIXED;}
+            else  {
+                std::cerr << "unknown pattern " << name << std::endl;
+                return 1;
+            }
+            generate = true;
+        }
+        else if(flag == "--gen-length")     {genConfig.length = std::strtoull(argv[++i], NULL, 10);}
+        else if(flag == "--gen-seed")       {genConfig.seed = std::strtoull(argv[++i], NULL, 10);}
+        else if(flag == "--gen-base")       {genConfig.base = std::strtoull(argv[++i], NULL, 16);}
+        else if(flag == "--gen-footprint")  {genConfig.footprint = std::strtoull(argv[++i], NULL, 10);}
+        else if(flag == "--gen-stride")     {genConfig.stride = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--gen-writes")     {genConfig.writes = std::strtoul(argv[++i], NULL, 10);}
+        else if(flag == "--gen-skew")       {genConfig.skew = std::strtod(argv[++i], NULL);}
+        else if(flag == "--gen-out")        {genOut = argv[++i];}
+        else if(flag == "--serve")          {servePath = argv[++i];}
+        else if(flag == "--format")
+        {
+            std::string name = argv[++i];
+            if(name == "auto")          {traceFormat = C_TRAC_AUTO;}
+            else if(name == "text")     {traceFormat = C_TRAC_TEXT;}
+            else if(name == "binary")   {traceFormat = C_TRAC_BIN;}
+            else if(name == "lackey")   {traceFormat = C_TRAC_LACKEY;}
+            else if(name == "din")      {traceFormat = C_TRAC_DIN;}
+            else if(name == "champsim") {traceFormat = C_TRAC_CHAMPSIM;}
+            else  {
+                std::cerr << "unknown trace format " << name << std::endl;
+                return 1;
+            }
+        }
+        else  {
+            std::cerr << "unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    //trace synthesis only
+    if(generate && !genOut.empty())
+    {
+        TraceGenerator generator(genConfig);
+        return generator.writeBinary(genOut) ? 0 : 1;
+    }
+
+    //daemon, the caches come from its clients
+    if(!servePath.empty())
+    {
+        Server server;
+        if(!server.open(servePath))  {
+            return 1;
+        }
+        server.run();
+        return 0;
+    }
+
+    //a json/csv/table dump on stdout must parse, so everything else goes to stderr
+    bool dumpToStdout = statsFormat != C_STATS_TEXT && statsPath == "-";
+    std::ostream& text = dumpToStdout ? std::cerr : std::cout;
+    if(dumpToStdout && interval > 0 && seriesPath == "-")  {
+        std::cerr << "--interval needs --interval-out when the stats dump goes to stdout" << std::endl;
+        return 1;
+    }
+
+    text << "Cache Simulator" << std::endl;
+
+    if(filename.empty() && !generate)
+    {
+        std::cin >> cacheSize >> blockSize >> org >> repPolicy;  //cache parameters
+        std::cin >> filename;   //taking input for the filename
+    }
+    else if(cacheSize <= 0 || blockSize <= 0 || org < 0 || repPolicy < 0)
+    {
+        //stdin may be the trace itself, so nothing is read from it here
+        std::cerr << (generate ? "--generate" : "--trace")
+                  << " needs --cache-size, --block-size, --assoc and --policy" << std::endl;
+        return 1;
+    }
+
+    //flags are all checked before the trace is opened, so a bad one costs no decoding
+    if(!checkGeometry("cache", cacheSize, blockSize, org, repPolicy, addrBits) ||
+       (iCacheSize > 0 && !checkGeometry("--icache", iCacheSize, iBlockSize, iOrg, iRepPolicy, addrBits)))  {
+        return 1;
+    }
+    if(sectorSize > 0 &&
+       ((sectorSize & (sectorSize - 1)) != 0 || blockSize % sectorSize != 0 || blockSize / sectorSize > 64))  {
+        std::cerr << "--sector must be a power of 2 dividing the block, with at most 64 sectors" << std::endl;
+        return 1;
+    }
+    if(stlbSets > 0 && tlbSets == 0)  {
+        std::cerr << "--stlb needs --tlb" << std::endl;
+        return 1;
+    }
+    if(tlbSets > 0 && addrBits < C_PT_ADDR_BITS_MIN)  {
+        std::cerr << "--tlb needs --addr-bits of at least " << C_PT_ADDR_BITS_MIN << " to place the page tables" << std::endl;
+        return 1;
+    }
+    if(iTiming && iCacheSize == 0)  {
+        std::cerr << "--itiming needs --icache" << std::endl;
+        return 1;
+    }
+    if(numBanks > 1 && !timing)  {
+        std::cerr << "--banks only affects the --timing model" << std::endl;
+        return 1;
+    }
+    //per-access outcomes feed the timing models, the pc stats and the data check
+    if((timing || iTiming || pcTop > 0 || checkData) && samplePeriod > 0)  {
+        std::cerr << "timing, pc stats and data checks need every access simulated in detail, "
+                  << "drop the sampling flags" << std::endl;
+        return 1;
+    }
+    BufferedWriter* series = NULL;
+    if(interval > 0)
+    {
+        series = new BufferedWriter();
+        if(!series->open(seriesPath))  {
+            return 1;
+        }
+    }
+
+    //trace is decoded on a reader thread, overlapping with simulation
+    //accesses arrive whole, each cache splits them at its own block boundaries
+    //a generated trace is made on this thread, batch by batch
+    TraceReader reader;
+    TraceGenerator* generator = NULL;
+    HostProfiler profiler;
+    PerfCounters parseCounters;     //the reader thread's, opened and read on it
+    bool parseCounted = false;
+    long long parseCounts[C_PERF_EVENTS];
+    if(hostProfile && profiler.open() && !generate)
+    {
+        reader.setThreadHooks([&]()  {parseCounted = parseCounters.open();},
+                              [&]()  {if(parseCounted)  {parseCounters.read(parseCounts);}});
+    }
+    if(generate)  {
+        generator = new TraceGenerator(genConfig);
+    }
+    else if(!reader.open(filename, traceFormat, iCacheSize > 0))  {
+        return 1;
+    }
+
+    Memory* MainMem = new Memory(backedMemory || checkData); //creating a main memory object
+    Cache L1(MainMem,cacheSize, blockSize, org, repPolicy, addrBits, indexFunc); //creating a cache object
+    L1.setRandom(randomSeed, randomInvalid);
+    if(sectorSize > 0)  {
+        L1.setSectorSize(sectorSize);
+    }
+    if(setStats)  {
+        L1.enableSetStats();
+    }
+
+    Cache* L1I = NULL;
+    if(iCacheSize > 0)  {
+        L1I = new Cache(MainMem, iCacheSize, iBlockSize, iOrg, iRepPolicy, addrBits);
+        L1I->setRandom(randomSeed, randomInvalid);
+    }
+
+    //sampled run: stats are extrapolated from the measurement windows
+    Sampler* sampler = NULL;
+    if(samplePeriod > 0)  {
+        sampler = new Sampler(&L1, samplePeriod, sampleWindow, sampleWarmup);
+    }
+
+    Memory shadow(true);
+    if(checkData)  {
+        L1.setDataCheck(&shadow);
+    }
+    PcProfiler* pcProfiler = NULL;
+    if(pcTop > 0)  {
+        pcProfiler = new PcProfiler();
+    }
+    MemoryChannel channel(memBandwidth);
+    TimingModel* L1Timing = NULL;
+    TimingModel* L1ITiming = NULL;
+    std::vector<unsigned char> status(C_BATCH_SIZE * (1 + C_PT_LEVELS_MAX));
+    std::vector<unsigned char> iStatus(status.size());
+    if(numBanks > 1)
+    {
+        //block-interleaved unless told otherwise
+        L1.setBanks(numBanks, bankShiftGiven ? bankShift : log2((uint) blockSize), bankHash);
+        timingConfig.bankBusy = bankBusy;
+    }
+    timingConfig.ports = ports;
+
+    if(timing)  {
+        L1Timing = new TimingModel(timingConfig, &channel, &L1, blockSize);
+    }
+    if(iTiming && L1I != NULL)  {
+        L1ITiming = new TimingModel(iTimingConfig, &channel, L1I, iBlockSize);
+    }
+    //one front end issues both sides, so neither books the channel ahead of the other's clock
+    if(L1Timing != NULL && L1ITiming != NULL)  {
+        L1ITiming->shareClock(L1Timing);
+    }
+
+    //translation: page walks are spliced into the access stream ahead of the access
+    Tlb* tlb = NULL;
+    Tlb* stlb = NULL;
+    Mmu* mmu = NULL;
+    std::vector<Access> translated;
+    if(tlbSets > 0)
+    {
+        tlb = new Tlb(tlbSets, tlbWays, tlbPolicy);
+        if(stlbSets > 0)  {
+            stlb = new Tlb(stlbSets, stlbWays, stlbPolicy);
+        }
+
+        mmu = new Mmu(tlb, stlb, addrBits);
+        mmu->setDefaultPageSize(pageShift);
+        for(size_t r = 0; r < pageRanges.size(); r++)  {
+            mmu->addPageRange(pageRanges[r].start, pageRanges[r].end, pageRanges[r].shift);
+        }
+        translated.resize(C_BATCH_SIZE * (1 + C_PT_LEVELS_MAX));
+    }
+
+    ReuseProfiler* reuseProfiler = NULL;
+    if(reuse)  {
+        reuseProfiler = new ReuseProfiler(&L1, reusePerSet);
+    }
+
+    IntervalReporter* reporter = NULL;
+    if(series != NULL)  {
+        reporter = new IntervalReporter(&L1, *series, interval, seriesFormat);
+    }
+
+    //progress is sampled on its own thread, the loop only counts batches
+    ProgressReporter* progress = NULL;
+    if(progressPeriod > 0 || !progressPath.empty())
+    {
+        progress = new ProgressReporter((progressPeriod > 0) ? progressPeriod : 10, progressPeriod > 0, progressPath);
+        if(generator != NULL)  {
+            progress->start(progress->getAccesses(), genConfig.length);
+        }
+        else  {
+            progress->start(reader.getPosition(), reader.getSize());
+        }
+    }
+
+    //decoded accesses are handed over one batch at a time
+    Batch* batch;
+    profiler.enter(C_PHASE_INPUT);
+    while((batch = (generator != NULL) ? generator->acquire() : reader.acquire()) != NULL)
+    {
+        //one phase switch each per batch: an unsplit batch is a single chunk below, and a batch
+        //the interval reporter splits is charged to the simulation whole, so a short interval
+        //does not cost counter reads per chunk
+        profiler.enter(C_PHASE_SIMULATE);
+        profiler.hold(reporter != NULL && reporter->remaining() < batch->count);
+
+        uint done = 0;
+        while(done < batch->count)
+        {
+            //split the batch where an interval report falls due
+            uint run = batch->count - done;
+            //remaining() is 64-bit, so it only lowers run below the batch, never wraps it
+            if(reporter != NULL && run > reporter->remaining())  {
+                run = reporter->remaining();
+            }
+
+            Access* accesses = batch->accesses + done;
+            uint count = run;
+
+            if(mmu != NULL)
+            {
+                count = mmu->translate(accesses, run, translated.data());
+                accesses = translated.data();
+            }
+
+            if(sampler != NULL)
+            {
+                sampler->access(accesses, count);
+            }
+            else if(L1Timing != NULL || mmu != NULL || pcProfiler != NULL)
+            {
+                L1.access(accesses, count, false, status.data());
+                profiler.enter(C_PHASE_MODELS);
+                //with an I-side model too, both are timed together below
+                if(L1Timing != NULL && L1ITiming == NULL)  {
+                    L1Timing->advance(accesses, status.data(), count);
+                }
+                if(mmu != NULL)  {
+                    mmu->account(accesses, status.data(), count);
+                }
+                if(pcProfiler != NULL)  {
+                    pcProfiler->account(accesses, status.data(), count);
+                }
+            }
+            else
+            {
+                L1.access(accesses, count);
+            }
+
+            if(reuseProfiler != NULL || L1I != NULL)  {
+                profiler.enter(C_PHASE_MODELS);
+            }
+            if(reuseProfiler != NULL)  {
+                reuseProfiler->access(accesses, count);
+            }
+
+            //the I-cache is always simulated in full
+            if(L1ITiming != NULL)
+            {
+                L1I->access(accesses, count, true, iStatus.data());
+                if(L1Timing != NULL)  {
+                    advanceShared(L1Timing, status.data(), L1ITiming, iStatus.data(), accesses, count);
+                }
+                else  {
+                    L1ITiming->advance(accesses, iStatus.data(), count);
+                }
+            }
+            else if(L1I != NULL)
+            {
+                L1I->access(accesses, count, true);
+            }
+
+            if(reporter != NULL)
+            {
+                profiler.enter(C_PHASE_STATS);
+                reporter->advance(run);
+            }
+            done += run;
+        }
+        if(progress != NULL)  {
+            progress->advance(batch->count);
+        }
+        profiler.hold(false);
+        profiler.enter(C_PHASE_INPUT);
+        if(generator != NULL)  {generator->release(batch);}
+        else                   {reader.release(batch);}
+    }
+
+    if(progress != NULL)
+    {
+        progress->finish();
+        delete progress;
+    }
+
+    //a trace that broke off is not worth totals
+    if(generator == NULL && reader.hasFailed())  {
+        return 1;
+    }
+
+    profiler.enter(C_PHASE_STATS);
+    if(reporter != NULL)
+    {
+        //flushed before the totals, so stdout keeps its order
+        reporter->finish();
+        delete reporter;
+        if(!series->flush())  {
+            std::cerr << "writing the interval series failed" << std::endl;
+        }
+        delete series;
+    }
+
+    //totals, extrapolated when sampling
+    long long totals[S_COUNT];
+    if(sampler != NULL)  {
+        sampler->estimate(totals, !org);
+    }
+    else
+    {
+        L1.snapshot(totals);
+        if(org != 0)  {
+            totals[S_CAP] = 0;
+        }
+    }
+
+    //what the dump holds, one group per model in use; filled only when there is a dump
+    bool exporting = statsFormat != C_STATS_TEXT;
+    std::vector<StatGroup> statGroups;
+    if(exporting)
+    {
+        statGroups.resize(1);
+        statGroups[0].name = "l1";
+        addCacheStats(statGroups[0], totals);
+    }
+
+    if(statsFormat == C_STATS_TEXT)
+    {
+        for(int i = 0; i < S_PRINTED; i++)  {
+            std::cout << totals[i] << std::endl;
+        }
+
+        //misses above are per block; only shown once some access straddled blocks
+        if(sampler == NULL && totals[S_BLOCK] != totals[S_ACCESS])  {
+            std::cout << "split: " << totals[S_ACCESS] << " accesses, "
+                      << totals[S_BLOCK] << " block accesses" << std::endl;
+        }
+    }
+    if(sampler != NULL)
+    {
+        sampler->report(text, sampleError);
+        if(exporting)  {
+            statGroups.push_back(StatGroup("sampling"));
+            sampler->exportStats(statGroups.back());
+        }
+        delete sampler;
+    }
+
+    if(indexGiven)  {
+        L1.reportOccupancy(text, "sets: ");
+    }
+    if(sectorSize > 0)
+    {
+        L1.reportTraffic(text, "sectors: ");
+        if(exporting)  {
+            statGroups.push_back(StatGroup("sectors"));
+            L1.exportTraffic(statGroups.back());
+        }
+    }
+    if(setStats)
+    {
+        L1.reportSets(text, "sets: ", hotSets);
+        if(!setCsv.empty())
+        {
+            std::ofstream csv(setCsv.c_str());
+            if(!csv)  {
+                std::cerr << "cannot write " << setCsv << std::endl;
+                return 1;
+            }
+            L1.writeSetCsv(csv);
+        }
+    }
+    if(MainMem->isBacked())
+    {
+        text << "memory: pages " << MainMem->getPages() << " ("
+             << MainMem->getPages() * C_MEM_PAGE_WORDS * sizeof(uint) / 1024 << " KiB)";
+        if(checkData)  {
+            text << " data mismatches " << L1.stat_data_mismatch;
+        }
+        text << std::endl;
+
+        if(exporting)
+        {
+            statGroups.push_back(StatGroup("memory"));
+            addStat(statGroups.back(), "pages", (long long) MainMem->getPages(), "pages",
+                    "pages of backing store touched");
+            if(checkData)  {
+                addStat(statGroups.back(), "data_mismatches", (long long) L1.stat_data_mismatch, "reads",
+                        "reads that differed from the shadow memory");
+            }
+        }
+    }
+    if(reuseProfiler != NULL)
+    {
+        reuseProfiler->report(text);
+        delete reuseProfiler;
+    }
+    if(pcProfiler != NULL)
+    {
+        pcProfiler->report(text, pcTop);
+        if(exporting)  {
+            statGroups.push_back(StatGroup("pc"));
+            pcProfiler->exportStats(statGroups.back(), pcTop);
+        }
+        delete pcProfiler;
+    }
+
+    if(L1I != NULL)
+    {
+        //same fields as above, on one line
+        long long values[S_COUNT];
+        L1I->snapshot(values);
+        if(iOrg != 0)  {
+            values[S_CAP] = 0;
+        }
+
+        if(statsFormat == C_STATS_TEXT)
+        {
+            std::cout << "icache:";
+            for(int i = 0; i < S_PRINTED; i++)  {
+                std::cout << " " << values[i];
+            }
+            std::cout << std::endl;
+        }
+        if(exporting)  {
+            statGroups.push_back(StatGroup("icache"));
+            addCacheStats(statGroups.back(), values);
+        }
+        delete L1I;
+    }
+
+    if(L1Timing != NULL)
+    {
+        L1Timing->report(text, "timing: ");
+        if(exporting)  {
+            statGroups.push_back(StatGroup("timing"));
+            L1Timing->exportStats(statGroups.back());
+        }
+        delete L1Timing;
+    }
+    if(L1ITiming != NULL)
+    {
+        L1ITiming->report(text, "itiming: ");
+        if(exporting)  {
+            statGroups.push_back(StatGroup("itiming"));
+            L1ITiming->exportStats(statGroups.back());
+        }
+        delete L1ITiming;
+    }
+    if(L1Timing != NULL || L1ITiming != NULL)
+    {
+        text << "timing: memory channel busy " << channel.busyCycles << " cycles" << std::endl;
+        if(exporting)  {
+            statGroups.push_back(StatGroup("channel"));
+            addStat(statGroups.back(), "busy_cycles", (long long) channel.busyCycles, "cycles",
+                    "cycles the memory channel was transferring");
+        }
+    }
+
+    if(mmu != NULL)
+    {
+        //a generated trace has no instructions
+        unsigned long long instructions = (generator != NULL) ? 0 : reader.getInstructions();
+        mmu->report(text, instructions);
+        if(exporting)  {
+            statGroups.push_back(StatGroup("tlb"));
+            mmu->exportStats(statGroups.back(), instructions);
+        }
+        delete mmu;
+        delete tlb;
+        delete stlb;
+    }
+    delete generator;
+
+    if(exporting)
+    {
+        if(dumpToStdout)  {
+            writeStats(std::cout, statsFormat, statGroups);
+        }
+        else
+        {
+            std::ofstream statsFile(statsPath.c_str());
+            writeStats(statsFile, statsFormat, statGroups);
+            if(!statsFile)  {
+                std::cerr << "cannot write " << statsPath << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    //last, so the stats phase covers every report above
+    if(profiler.isOpen())
+    {
+        if(parseCounted)  {
+            profiler.add(C_PHASE_PARSE, parseCounts);
+        }
+        profiler.report(text, totals[S_ACCESS]);
+    }
+
+    return 0;   //succesful run of the code
+}
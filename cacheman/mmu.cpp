@@ -0,0 +1,276 @@
+#include "mmu.h"
+#include "policy.h"
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : TLBs and the page walker
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//////////////////////////////////////////////////////////////////////
+/////////////////////      TLB DEFINITIONS      //////////////////////
+//////////////////////////////////////////////////////////////////////
+
+Tlb::Tlb(uint numSets, uint numWays, int repPolicy)
+{
+    this->numSets = (numSets > 0) ? numSets : 1;
+    this->numWays = (numWays > 0) ? numWays : 1;
+    this->repPolicy = repPolicy;
+
+    uint entries = this->numSets * this->numWays;
+    tags = new addr_t[entries]();
+    pageShift = new unsigned char[entries]();
+    lastUse = new unsigned long long[entries]();
+    counter = new uint[this->numSets]();
+    tree = new bool[this->numSets * this->numWays]();
+}
+
+Tlb::~Tlb()
+{
+    delete[] tags;
+    delete[] pageShift;
+    delete[] lastUse;
+    delete[] counter;
+    delete[] tree;
+}
+
+uint Tlb::getSet(addr_t vpn)
+{
+    return vpn & (numSets - 1);
+}
+
+void Tlb::touch(uint set, uint way)
+{
+    lastUse[set * numWays + way] = ++clock;
+
+    if(repPolicy == C_CRP_TREE)
+    {
+        //point the path to the root away from this way, as in TreeVictimManager
+        bool* bits = tree + set * numWays;
+        int curr = way + numWays - 1;
+        while(curr > 0)  {
+            bits[(curr - 1) / 2] = (curr % 2);
+            curr = (curr - 1) / 2;
+        }
+    }
+}
+
+uint Tlb::getVictim(uint set)
+{
+    uint base = set * numWays;
+
+    //free entries first
+    for(uint w = 0; w < numWays; w++)  {
+        if(pageShift[base + w] == 0)  {
+            return w;
+        }
+    }
+
+    if(repPolicy == C_CRP_RANDOM)
+    {
+        uint w = counter[set];
+        counter[set] = (w + 1) % numWays;
+        return w;
+    }
+    if(repPolicy == C_CRP_XORSHIFT)  {
+        return pickRandom(randomState, numWays);
+    }
+    if(repPolicy == C_CRP_TREE)
+    {
+        bool* bits = tree + base;
+        uint curr = 0;
+        while(curr < numWays - 1)  {
+            curr = (2 * curr) + bits[curr] + 1;
+        }
+        return curr - numWays + 1;
+    }
+
+    uint oldest = 0;
+    for(uint w = 1; w < numWays; w++)  {
+        if(lastUse[base + w] < lastUse[base + oldest])  {
+            oldest = w;
+        }
+    }
+    return oldest;
+}
+
+bool Tlb::lookup(addr_t va, uint shift)
+{
+    stat_tlb_access++;
+
+    addr_t vpn = va >> shift;
+    uint set = getSet(vpn);
+    uint base = set * numWays;
+
+    for(uint w = 0; w < numWays; w++)  {
+        if(pageShift[base + w] == shift && tags[base + w] == vpn)  {
+            touch(set, w);
+            return true;
+        }
+    }
+
+    stat_tlb_miss++;
+    return false;
+}
+
+void Tlb::insert(addr_t va, uint shift)
+{
+    addr_t vpn = va >> shift;
+    uint set = getSet(vpn);
+    uint way = getVictim(set);
+
+    tags[set * numWays + way] = vpn;
+    pageShift[set * numWays + way] = shift;
+    touch(set, way);
+}
+
+Mmu::Mmu(Tlb* l1, Tlb* l2, int addrBits)
+{
+    this->l1 = l1;
+    this->l2 = l2;
+    this->addrBits = addrBits;
+    this->levels = (addrBits > C_PAGE_4K + 4 * C_PT_BITS) ? 5 : 4;
+
+    int bits = (addrBits > C_PT_ADDR_BITS_MIN) ? addrBits : C_PT_ADDR_BITS_MIN;
+    ptBase = (addr_t) 0xF << (bits - 4);
+    ptPages = ((addr_t) 1 << (bits - 4)) >> C_PAGE_4K;
+}
+
+void Mmu::addPageRange(addr_t start, addr_t end, uint shift)
+{
+    PageRange range;
+    range.start = start;
+    range.end = end;
+    range.shift = shift;
+    ranges.push_back(range);
+}
+
+uint Mmu::getPageShift(addr_t va)
+{
+    for(size_t r = 0; r < ranges.size(); r++)  {
+        if(va >= ranges[r].start && va < ranges[r].end)  {
+            return ranges[r].shift;
+        }
+    }
+    return defaultShift;
+}
+
+addr_t Mmu::getPteAddress(addr_t va, int level)
+{
+    //each level resolves C_PT_BITS above the 4K offset, root first
+    int low = C_PAGE_4K + C_PT_BITS * (levels - 1 - level);
+    addr_t entry = (va >> low) & ((1 << C_PT_BITS) - 1);
+    addr_t prefix = va >> (low + C_PT_BITS);    //picks the table at this level
+
+    //scatter the tables over the page-table region, deterministically
+    addr_t h = (prefix << 3) ^ (addr_t) level;
+    h += 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+
+    addr_t table = ptBase + ((h % ptPages) << C_PAGE_4K);
+    return table + entry * C_PTE_WORDS;
+}
+
+uint Mmu::translate(const Access* in, uint count, Access* out)
+{
+    uint n = 0;
+
+    for(uint i = 0; i < count; i++)
+    {
+        //instruction fetches are not translated here
+        if(!in[i].fetch)
+        {
+            addr_t va = in[i].address;
+            uint shift = getPageShift(va);
+
+            bool hit = l1->lookup(va, shift);
+            if(!hit && l2 != NULL)
+            {
+                hit = l2->lookup(va, shift);
+                if(hit)  {
+                    l1->insert(va, shift);
+                }
+            }
+
+            if(!hit)
+            {
+                //walk: one read per level down to the leaf of this page size
+                int leaf = levels - 1 - (shift - C_PAGE_4K) / C_PT_BITS;
+                for(int level = 0; level <= leaf; level++)
+                {
+                    out[n] = Access();
+                    out[n].address = getPteAddress(va, level);
+                    out[n].size = C_PTE_WORDS;
+                    out[n].walk = true;
+                    n++;
+                }
+
+                stat_walks++;
+                stat_walk_reads += leaf + 1;
+
+                if(l2 != NULL)  {
+                    l2->insert(va, shift);
+                }
+                l1->insert(va, shift);
+            }
+        }
+
+        out[n++] = in[i];
+    }
+
+    return n;
+}
+
+void Mmu::account(const Access* accesses, const unsigned char* status, uint count)
+{
+    for(uint i = 0; i < count; i++)  {
+        if(accesses[i].walk && status[i] != C_HIT)  {
+            stat_walk_misses++;
+        }
+    }
+}
+
+void Mmu::report(std::ostream& out, unsigned long long instructions)
+{
+    //misses per thousand instructions, or per thousand translations without them
+    const char* unit = (instructions > 0) ? "mpki" : "mpka";
+    double scale = (instructions > 0) ? instructions : l1->stat_tlb_access;
+    if(scale == 0)  {
+        scale = 1;
+    }
+
+    out << "tlb: l1 accesses " << l1->stat_tlb_access << " misses " << l1->stat_tlb_miss
+        << " " << unit << " " << 1000.0 * l1->stat_tlb_miss / scale << std::endl;
+    if(l2 != NULL)  {
+        out << "tlb: l2 accesses " << l2->stat_tlb_access << " misses " << l2->stat_tlb_miss
+            << " " << unit << " " << 1000.0 * l2->stat_tlb_miss / scale << std::endl;
+    }
+    out << "tlb: walks " << stat_walks << " page-table reads " << stat_walk_reads
+        << " l1 misses " << stat_walk_misses << std::endl;
+}
+
+void Mmu::exportStats(StatGroup& group, unsigned long long instructions)
+{
+    //the same rates as report(), keyed by what they are per
+    std::string per = (instructions > 0) ? "_mpki" : "_mpka";
+    const char* unit = (instructions > 0) ? "misses/kilo-instruction" : "misses/kilo-access";
+    double scale = (instructions > 0) ? instructions : l1->stat_tlb_access;
+    if(scale == 0)  {
+        scale = 1;
+    }
+
+    addStat(group, "l1_accesses", (long long) l1->stat_tlb_access, "accesses", "L1 TLB lookups");
+    addStat(group, "l1_misses", (long long) l1->stat_tlb_miss, "misses", "L1 TLB misses");
+    addStat(group, "l1" + per, 1000.0 * l1->stat_tlb_miss / scale, unit, "L1 TLB miss rate");
+    if(l2 != NULL)
+    {
+        addStat(group, "l2_accesses", (long long) l2->stat_tlb_access, "accesses", "L2 TLB lookups");
+        addStat(group, "l2_misses", (long long) l2->stat_tlb_miss, "misses", "L2 TLB misses");
+        addStat(group, "l2" + per, 1000.0 * l2->stat_tlb_miss / scale, unit, "L2 TLB miss rate");
+    }
+    addStat(group, "walks", (long long) stat_walks, "walks", "page-table walks");
+    addStat(group, "walk_reads", (long long) stat_walk_reads, "accesses", "page-table reads of the walks");
+    addStat(group, "walk_misses", (long long) stat_walk_misses, "misses", "page-table reads that missed in the L1");
+}
@@ -0,0 +1,109 @@
+#ifndef CACHEMAN_MMU_H
+#define CACHEMAN_MMU_H
+
+#include "cache.h"
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : TLBs and the page walker in front of the data cache
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+// Pages (shifts), and the deepest page walk; addresses count 32-bit words, like Cache and Memory
+// (byte-addressed traces are turned into words as they are parsed, see C_TRAC_WORD_SHIFT)
+#define C_PAGE_4K 10    //4 KiB: 1024 words
+#define C_PAGE_2M 19
+#define C_PAGE_1G 28
+#define C_PT_LEVELS_MAX 5
+#define C_PT_BITS 9         //address bits each table level resolves: 512 entries
+#define C_PTE_WORDS 2       //one 8-byte entry, so a table fills a 4 KiB page
+#define C_PT_ADDR_BITS_MIN (C_PAGE_4K + 4)  //narrowest addresses with room for one table frame
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : Tlb, Mmu
+*    Application        : TLB hierarchy next to the data cache; an L1 and an optional L2 TLB with
+*                         their own sets, ways and replacement, 4K/2M/1G pages, and a radix page
+*                         walk whose page-table reads are fed through the L1 like any other load
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//one TLB level; entries are tagged with their page size
+class Tlb
+{
+private:
+    uint numSets;
+    uint numWays;
+    int  repPolicy;     //C_CRP_*, as for the cache
+
+    //entries by set * numWays + way
+    addr_t* tags;                   //virtual page number
+    unsigned char* pageShift;       //0 for an invalid entry
+    unsigned long long* lastUse;    //LRU timestamps
+    uint* counter;                  //per-set round-robin slot for C_CRP_RANDOM
+    unsigned long long randomState = seedRandom(1);    //for C_CRP_XORSHIFT
+    bool* tree;                     //per-set PLRU bits for C_CRP_TREE
+    unsigned long long clock = 0;
+
+    uint getSet(addr_t vpn);
+    void touch(uint set, uint way);
+    uint getVictim(uint set);
+public:
+    unsigned long long stat_tlb_access = 0;
+    unsigned long long stat_tlb_miss = 0;
+
+    Tlb(uint numSets, uint numWays, int repPolicy);
+    ~Tlb();
+
+    //looks up the page of <va>; on a miss nothing is filled
+    bool lookup(addr_t va, uint shift);
+    void insert(addr_t va, uint shift);
+};
+
+//a virtual range mapped with one page size
+typedef struct PageRangest
+{
+    addr_t  start = 0;
+    addr_t  end   = 0;      //exclusive
+    uint    shift = C_PAGE_4K;
+}  PageRange;
+
+class Mmu
+{
+private:
+    Tlb* l1;
+    Tlb* l2;            //NULL for a single level
+    int  levels;        //page-table levels for a 4K page (4 up to 48-bit byte addresses, else 5)
+    int  addrBits;
+
+    uint defaultShift = C_PAGE_4K;
+    std::vector<PageRange> ranges;
+
+    addr_t ptBase;      //page tables live in the top 1/16th of the address space
+    addr_t ptPages;     //4K table frames available there
+
+    uint getPageShift(addr_t va);
+    //address of the level-<level> entry (0: root) mapping <va>
+    addr_t getPteAddress(addr_t va, int level);
+public:
+    unsigned long long stat_walks = 0;
+    unsigned long long stat_walk_reads = 0;
+    unsigned long long stat_walk_misses = 0;    //page-table reads that missed in the L1
+
+    //<addrBits> below C_PT_ADDR_BITS_MIN leave no room for the tables; they are then placed as if
+    //the addresses were that wide, and alias under the cache's address mask
+    Mmu(Tlb* l1, Tlb* l2, int addrBits);
+
+    void setDefaultPageSize(uint shift)  {defaultShift = shift;}
+    void addPageRange(addr_t start, addr_t end, uint shift);
+
+    //copies the data accesses to out[], each preceded by the page-table reads of its walk
+    //when it misses every TLB level; out[] needs room for count * (1 + C_PT_LEVELS_MAX)
+    uint translate(const Access* in, uint count, Access* out);
+    //tallies L1 misses of the page-table reads, from Cache::access() status
+    void account(const Access* accesses, const unsigned char* status, uint count);
+
+    //MPKI against <instructions>, per 1000 translations when the trace has no instructions
+    void report(std::ostream& out, unsigned long long instructions);
+    void exportStats(StatGroup& group, unsigned long long instructions);
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "perf.h"
+
+#include <cstring>
+#include <cerrno>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Host performance counters around the phases of a run (see perf.h)
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+static const unsigned long long perfConfigs[C_PERF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+static const char* perfNames[C_PERF_EVENTS] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+static const char* phaseNames[C_PHASE_COUNT] = {"parse", "input", "simulate", "models", "stats"};
+
+//group read layout with PERF_FORMAT_GROUP and both times: nr, enabled, running, values[nr]
+#define C_PERF_READ (3 + C_PERF_EVENTS)
+
+//////////////////////////////////////////////////////////////////////
+////////////////////      PERF DEFINITIONS      //////////////////////
+//////////////////////////////////////////////////////////////////////
+
+PerfCounters::PerfCounters()
+{
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        fds[e] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        if(fds[e] >= 0)  {
+            close(fds[e]);
+        }
+    }
+}
+
+bool PerfCounters::open()
+{
+    for(int e = 0; e < C_PERF_EVENTS; e++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = perfConfigs[e];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        //cycles lead the group, the other events are optional members
+        int group = (e == C_PERF_CYCLES) ? -1 : fds[C_PERF_CYCLES];
+        fds[e] = syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+        if(fds[C_PERF_CYCLES] < 0)
+        {
+            std::cerr << "host counters unavailable: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void PerfCounters::read(long long* values)
+{
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        values[e] = -1;
+    }
+
+    unsigned long long data[C_PERF_READ];
+    if(::read(fds[C_PERF_CYCLES], data, sizeof(data)) < (ssize_t) (3 * sizeof(data[0])))  {
+        return;
+    }
+
+    //members come in the order they were opened, skipping those that failed
+    double scale = (data[2] > 0) ? (double) data[1] / data[2] : 1.0;
+    unsigned long long member = 0;
+    for(int e = 0; e < C_PERF_EVENTS && member < data[0]; e++)  {
+        if(fds[e] >= 0)  {
+            values[e] = (long long) (data[3 + member++] * scale);
+        }
+    }
+}
+
+HostProfiler::HostProfiler()
+{
+    memset(totals, 0, sizeof(totals));
+    memset(counted, 0, sizeof(counted));
+}
+
+bool HostProfiler::open()
+{
+    if(!counters.open())  {
+        return false;
+    }
+    counters.read(mark);
+    enabled = true;
+    return true;
+}
+
+void HostProfiler::charge()
+{
+    long long now[C_PERF_EVENTS], delta[C_PERF_EVENTS];
+    counters.read(now);
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        delta[e] = (now[e] < 0 || mark[e] < 0) ? -1 : now[e] - mark[e];
+        mark[e] = now[e];
+    }
+    if(phase >= 0)  {
+        add(phase, delta);
+    }
+}
+
+void HostProfiler::add(int phase, const long long* values)
+{
+    //an event missing once stays missing
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        totals[phase][e] = (values[e] < 0 || totals[phase][e] < 0) ? -1 : totals[phase][e] + values[e];
+    }
+    counted[phase] = true;
+}
+
+void HostProfiler::report(std::ostream& out, unsigned long long accesses)
+{
+    //whatever ran since the last phase change
+    charge();
+
+    out << "host: " << std::left << std::setw(10) << "phase";
+    for(int e = 0; e < C_PERF_EVENTS; e++)  {
+        out << " " << std::right << std::setw(14) << perfNames[e];
+    }
+    out << " " << std::setw(14) << "cycles/access" << std::endl;
+
+    long long sum[C_PERF_EVENTS] = {0};
+    for(int p = 0; p <= C_PHASE_COUNT; p++)
+    {
+        //the last row is the total over every phase counted
+        const long long* values = sum;
+        if(p < C_PHASE_COUNT)
+        {
+            if(!counted[p])  {
+                continue;
+            }
+            values = totals[p];
+            for(int e = 0; e < C_PERF_EVENTS; e++)  {
+                sum[e] = (sum[e] < 0 || values[e] < 0) ? -1 : sum[e] + values[e];
+            }
+        }
+
+        out << "host: " << std::left << std::setw(10) << ((p < C_PHASE_COUNT) ? phaseNames[p] : "total");
+        for(int e = 0; e < C_PERF_EVENTS; e++)
+        {
+            out << " " << std::right << std::setw(14);
+            if(values[e] < 0)  {out << "-";}
+            else               {out << values[e];}
+        }
+        out << " " << std::setw(14) << std::fixed << std::setprecision(2)
+            << ((accesses > 0) ? (double) values[C_PERF_CYCLES] / accesses : 0.0) << std::endl;
+        out.unsetf(std::ios::fixed);
+        out << std::setprecision(6);
+    }
+}
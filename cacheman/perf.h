@@ -0,0 +1,92 @@
+#ifndef CACHEMAN_PERF_H
+#define CACHEMAN_PERF_H
+
+#include "cache.h"
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Self-profiling of the simulator with host performance counters (perf_event_open)
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//host events, counted together in one group
+#define C_PERF_CYCLES        0
+#define C_PERF_INSTRUCTIONS  1
+#define C_PERF_LLC_MISSES    2
+#define C_PERF_BRANCH_MISSES 3
+#define C_PERF_EVENTS        4
+
+//phases of a run the events are charged to
+#define C_PHASE_PARSE    0  //decoding the trace, on the reader thread
+#define C_PHASE_INPUT    1  //simulation thread in acquire(): waiting for the reader, or generating
+#define C_PHASE_SIMULATE 2  //set lookup and miss handling of the L1 (and TLB walks spliced in),
+                            //and all of a batch an interval report falls inside
+#define C_PHASE_MODELS   3  //I-cache, timing, pc and reuse models fed by the L1 outcomes
+#define C_PHASE_STATS    4  //interval series, totals and reports
+#define C_PHASE_COUNT    5
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : PerfCounters, HostProfiler
+*    Application        : PerfCounters counts the C_PERF_* events of the thread that opened them,
+*                         user space only so the default perf_event_paranoid allows it; events the
+*                         host lacks read as -1. HostProfiler charges the counts of the simulation
+*                         thread to the phase it is in, one read per phase change (a batch or more
+*                         of accesses, never per access), and reports host cycles per access
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class PerfCounters
+{
+private:
+    int fds[C_PERF_EVENTS];
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    //opens the group on the calling thread, false (with the reason on stderr) if cycles cannot be
+    //counted at all
+    bool open();
+    bool isOpen()  {return fds[C_PERF_CYCLES] >= 0;}
+    //counts so far, scaled up when the kernel multiplexed the group
+    void read(long long* values);
+};
+
+class HostProfiler
+{
+private:
+    PerfCounters counters;
+    bool enabled = false;
+    int phase = -1;     //nothing is charged before the first enter()
+    bool held = false;
+    long long mark[C_PERF_EVENTS];
+    long long totals[C_PHASE_COUNT][C_PERF_EVENTS];
+    bool counted[C_PHASE_COUNT];
+
+    void charge();
+public:
+    HostProfiler();
+
+    //opens the counters on the calling thread; charging starts at the first enter()
+    bool open();
+    bool isOpen()  {return enabled;}
+
+    //charges the counts since the last call to the current phase and moves to <next>
+    inline void enter(int next)
+    {
+        if(enabled && !held && next != phase)
+        {
+            charge();
+            phase = next;
+        }
+    }
+
+    //while held, enter() stays in the current phase, for stretches too short to split
+    void hold(bool on)  {held = on;}
+
+    //adds counts taken on another thread, e.g. the reader's for C_PHASE_PARSE
+    void add(int phase, const long long* values);
+
+    //per phase and in total: the events and host cycles per simulated access
+    void report(std::ostream& out, unsigned long long accesses);
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef CACHEMAN_POLICY_H
+#define CACHEMAN_POLICY_H
+
+#include "cache.h"
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Replacement policies, one VictimManager per C_CRP_* value
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : VictimManager (and specific implementations)
+*    Application        : Assist in tracking victims in Set
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//base interface/abstract class
+class VictimManager
+{
+public:
+    virtual ~VictimManager() {}
+
+    //triggers bookkeeping for the replacement policy when a block is accessed
+    virtual void reflectBlockAccess(BlockNode* accessedPtr) = 0;
+    //gets the victim block address
+    virtual BlockNode* getVictim() = 0; //inclusive of invalid blocks
+};
+
+//random (counter-based, not random in the exact sense)
+//advantage: no need to check block validity
+class RandomVictimManager : public VictimManager
+{
+private:
+    uint counter = 0;   //iterates across block linked list
+    Set* setRef = NULL; //refers to original set
+public:
+    RandomVictimManager(Set* sR);
+
+    //nothing to reflect here
+    void reflectBlockAccess(BlockNode* accessedPtr)  {}
+    BlockNode* getVictim();
+};
+
+//pseudo-random: a way drawn from the cache's seeded xorshift generator,
+//optionally after any invalid way
+class XorshiftVictimManager : public VictimManager
+{
+private:
+    Set* setRef = NULL;
+public:
+    XorshiftVictimManager(Set* sR);
+
+    //nothing to reflect here
+    void reflectBlockAccess(BlockNode* accessedPtr)  {}
+    BlockNode* getVictim();
+};
+
+//least recently used: brings accessed block to head
+//evicted: last block
+class LRUVictimManager : public VictimManager
+{
+private:
+    Set* setRef = NULL;
+public:
+    LRUVictimManager(Set* sR);
+
+    void reflectBlockAccess(BlockNode* accessedPtr);
+    BlockNode* getVictim();
+};
+
+//tree-based psuedo-lru: uses a complete binary tree
+class TreeVictimManager : public VictimManager
+{
+private:
+    //a bool array representing the tree
+    bool* tree = NULL;
+    Set* setRef = NULL;
+
+    //needed for tree implementation
+    uint setSize;
+public:
+    TreeVictimManager(Set* sR);
+    ~TreeVictimManager();
+
+    void reflectBlockAccess(BlockNode* accessedPtr);
+    BlockNode* getVictim();
+};
+
+#endif
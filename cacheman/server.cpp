@@ -0,0 +1,465 @@
+#include "server.h"
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Simulation daemon serving the C_SRV_* protocol (see server.h)
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//set from the signal handler, polled between frames
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+static inline uint getLE32(const char* p)
+{
+    const unsigned char* u = (const unsigned char*) p;
+    return u[0] | (u[1] << 8) | (u[2] << 16) | ((uint) u[3] << 24);
+}
+
+static inline addr_t getLE64(const char* p)
+{
+    return getLE32(p) | ((addr_t) getLE32(p + 4) << 32);
+}
+
+static inline void appendLE32(std::string& out, uint value)
+{
+    for(int k = 0; k < 4; k++)  {
+        out += (char) (value >> (8 * k));
+    }
+}
+
+static inline void appendLE64(std::string& out, unsigned long long value)
+{
+    for(int k = 0; k < 8; k++)  {
+        out += (char) (value >> (8 * k));
+    }
+}
+
+//takes a u8-length name off the front of [p, end), false if it does not fit
+static bool takeName(const char*& p, const char* end, std::string& name)
+{
+    if(p >= end)  {
+        return false;
+    }
+    uint length = (unsigned char) *p++;
+    if(length == 0 || (size_t) (end - p) < length)  {
+        return false;
+    }
+    name.assign(p, length);
+    p += length;
+    return true;
+}
+
+static bool isPow2(uint x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+////////////////////      SERVER DEFINITIONS      ////////////////////
+//////////////////////////////////////////////////////////////////////
+
+Server::~Server()
+{
+    for(size_t i = 0; i < clients.size(); i++)  {
+        close(clients[i].fd);
+    }
+    if(listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(path.c_str());
+    }
+    for(std::map<std::string, ResidentCache>::iterator it = caches.begin(); it != caches.end(); it++)  {
+        destroy(it->second);
+    }
+}
+
+void Server::build(ResidentCache& resident)
+{
+    destroy(resident);
+    resident.memory = new Memory();
+    resident.cache = new Cache(resident.memory, resident.cacheSize, resident.blockSize, resident.assoc,
+                               resident.policy, resident.addrBits, resident.indexFunc);
+    if(resident.sectorSize > 0)  {
+        resident.cache->setSectorSize(resident.sectorSize);
+    }
+}
+
+void Server::destroy(ResidentCache& resident)
+{
+    delete resident.cache;
+    delete resident.memory;
+    resident.cache = NULL;
+    resident.memory = NULL;
+}
+
+bool Server::open(const std::string& path)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path))  {
+        std::cerr << "socket path too long: " << path << std::endl;
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    //a socket file left by a server that died is in the way of bind(); anything else at the
+    //path, a live server's socket included, is left alone
+    struct stat info;
+    if(lstat(path.c_str(), &info) == 0)
+    {
+        if(!S_ISSOCK(info.st_mode))  {
+            std::cerr << path << " exists and is not a socket" << std::endl;
+            return false;
+        }
+
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool stale = probe >= 0 && connect(probe, (struct sockaddr*) &address, sizeof(address)) != 0 &&
+                     errno == ECONNREFUSED;
+        if(probe >= 0)  {
+            close(probe);
+        }
+        if(!stale)  {
+            std::cerr << "a server may still be listening on " << path << std::endl;
+            return false;
+        }
+        unlink(path.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listenFd < 0)  {
+        std::cerr << "cannot create a socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if(bind(listenFd, (struct sockaddr*) &address, sizeof(address)) != 0 || listen(listenFd, 16) != 0)
+    {
+        std::cerr << "cannot listen on " << path << ": " << strerror(errno) << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    this->path = path;
+    return true;
+}
+
+void Server::run()
+{
+    //no SA_RESTART, so poll() returns on the signal
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    std::vector<struct pollfd> fds;
+    while(!stopRequested)
+    {
+        //the listening socket first, then one entry per client: readable while its queued
+        //replies are under the limit, writable while any are queued
+        fds.resize(clients.size() + 1);
+        fds[0].fd = listenFd;
+        fds[0].events = POLLIN;
+        for(size_t i = 0; i < clients.size(); i++)
+        {
+            fds[i + 1].fd = clients[i].fd;
+            fds[i + 1].events = 0;
+            if(clients[i].out.size() - clients[i].sent < C_SRV_OUT_MAX)  {
+                fds[i + 1].events |= POLLIN;
+            }
+            if(clients[i].sent < clients[i].out.size())  {
+                fds[i + 1].events |= POLLOUT;
+            }
+        }
+
+        if(poll(fds.data(), fds.size(), -1) < 0)  {
+            if(errno == EINTR)  {
+                continue;
+            }
+            std::cerr << "poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        //clients first, back to front so closing one keeps the indices of the rest
+        for(size_t i = clients.size(); i > 0; i--)
+        {
+            Client& client = clients[i - 1];
+            short events = fds[i].revents;
+            if(events == 0)  {
+                continue;
+            }
+
+            //sending first may let frames held back by a full queue be answered
+            bool open = true;
+            if(events & POLLOUT)  {
+                open = send(client);
+            }
+            if(open && (events & (POLLIN | POLLHUP | POLLERR)))  {
+                open = receive(client);
+            }
+            if(open)  {
+                open = answer(client) && send(client);
+            }
+            if(!open)
+            {
+                close(client.fd);
+                clients.erase(clients.begin() + (i - 1));
+            }
+        }
+
+        if(fds[0].revents & POLLIN)
+        {
+            int fd = accept(listenFd, NULL, NULL);
+            if(fd >= 0)  {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                Client client;
+                client.fd = fd;
+                clients.push_back(client);
+            }
+        }
+    }
+}
+
+bool Server::receive(Client& client)
+{
+    size_t used = client.in.size();
+    client.in.resize(used + C_SRV_READ);
+    ssize_t n = ::recv(client.fd, client.in.data() + used, C_SRV_READ, 0);
+    if(n < 0)
+    {
+        client.in.resize(used);
+        return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if(n == 0)  {
+        return false;   //closed by the client
+    }
+    client.in.resize(used + n);
+    return true;
+}
+
+bool Server::answer(Client& client)
+{
+    //every complete frame in what has arrived, until the replies back up
+    size_t at = 0;
+    while(client.in.size() - at >= 4 && client.out.size() - client.sent < C_SRV_OUT_MAX)
+    {
+        uint length = getLE32(client.in.data() + at);
+        if(length == 0 || length > C_SRV_FRAME_MAX)  {
+            return false;
+        }
+        if(client.in.size() - at - 4 < length)  {
+            break;
+        }
+
+        reply.clear();
+        int result = handle(client.in.data() + at + 4, length);
+
+        appendLE32(client.out, reply.size() + 1);
+        client.out += (char) result;
+        client.out += reply;
+
+        at += 4 + length;
+    }
+
+    client.in.erase(client.in.begin(), client.in.begin() + at);
+    return true;
+}
+
+bool Server::send(Client& client)
+{
+    while(client.sent < client.out.size())
+    {
+        ssize_t n = ::send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent,
+                           MSG_NOSIGNAL);
+        if(n < 0)  {
+            //full: the rest goes out on POLLOUT
+            return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.sent += n;
+    }
+
+    client.out.clear();
+    client.sent = 0;
+    return true;
+}
+
+int Server::handle(const char* frame, uint length)
+{
+    const char* p = frame + 1;
+    const char* end = frame + length;
+    int op = (unsigned char) frame[0];
+
+    if(op == C_SRV_LIST)
+    {
+        for(std::map<std::string, ResidentCache>::iterator it = caches.begin(); it != caches.end(); it++)  {
+            reply += it->first;
+            reply += '\n';
+        }
+        return C_SRV_OK;
+    }
+
+    std::string name;
+    if(!takeName(p, end, name))  {
+        return C_SRV_INVALID;
+    }
+
+    if(op == C_SRV_CREATE)
+    {
+        if(end - p != 7 * 4)  {
+            return C_SRV_INVALID;
+        }
+        if(caches.find(name) != caches.end())  {
+            return C_SRV_EXISTS;
+        }
+
+        ResidentCache resident;
+        resident.cacheSize = getLE32(p);
+        resident.blockSize = getLE32(p + 4);
+        resident.assoc = getLE32(p + 8);
+        resident.policy = getLE32(p + 12);
+        uint addrBits = getLE32(p + 16);
+        resident.addrBits = (addrBits > 0) ? addrBits : C_ADDR_BITS;
+        resident.indexFunc = getLE32(p + 20);
+        resident.sectorSize = getLE32(p + 24);
+
+        //the same limits the command line and the C API apply
+        uint cacheSize = resident.cacheSize, blockSize = resident.blockSize, assoc = resident.assoc;
+        uint sector = resident.sectorSize;
+        if(!isPow2(cacheSize) || !isPow2(blockSize) || blockSize > cacheSize || cacheSize > (1u << 30) ||
+           (assoc != 0 && (!isPow2(assoc) || assoc > cacheSize / blockSize)) ||
+           resident.policy < C_CRP_RANDOM || resident.policy > C_CRP_XORSHIFT ||
+           resident.addrBits <= log2(blockSize) || resident.addrBits > C_ADDR_LEN || resident.indexFunc < C_IDX_MODULO || resident.indexFunc > C_IDX_SKEW ||
+           (sector != 0 && (!isPow2(sector) || blockSize % sector != 0 || blockSize / sector > 64)))  {
+            return C_SRV_INVALID;
+        }
+
+        build(resident);
+        caches[name] = resident;
+        return C_SRV_OK;
+    }
+
+    std::map<std::string, ResidentCache>::iterator it = caches.find(name);
+    if(it == caches.end())  {
+        return C_SRV_UNKNOWN;
+    }
+    ResidentCache& resident = it->second;
+
+    if(op == C_SRV_ACCESS)
+    {
+        return access(resident, p, end);
+    }
+    else if(op == C_SRV_STATS)
+    {
+        long long values[S_COUNT];
+        resident.cache->snapshot(values);
+        if(resident.assoc != 0)  {
+            values[S_CAP] = 0;  //as main() prints it
+        }
+
+        appendLE32(reply, S_COUNT);
+        for(int i = 0; i < S_COUNT; i++)  {
+            appendLE64(reply, values[i]);
+        }
+        return C_SRV_OK;
+    }
+    else if(op == C_SRV_REPORT)
+    {
+        report(resident);
+        return C_SRV_OK;
+    }
+    else if(op == C_SRV_RESET)
+    {
+        build(resident);
+        return C_SRV_OK;
+    }
+    else if(op == C_SRV_DROP)
+    {
+        destroy(resident);
+        caches.erase(it);
+        return C_SRV_OK;
+    }
+
+    return C_SRV_INVALID;
+}
+
+int Server::access(ResidentCache& resident, const char* p, const char* end)
+{
+    if(p >= end || (end - p - 1) % C_SRV_RECORD != 0)  {
+        return C_SRV_INVALID;
+    }
+    bool wantStatus = (*p++ != 0);
+    uint count = (end - p) / C_SRV_RECORD;
+
+    //every block of an access is walked, so one huge size would hold up every client
+    for(const char* r = p; r < end; r += C_SRV_RECORD)  {
+        if(getLE32(r + 8) > C_ACCESS_MAX)  {
+            return C_SRV_INVALID;
+        }
+    }
+
+    if(batch.size() < C_BATCH_SIZE)  {
+        batch.resize(C_BATCH_SIZE);
+        status.resize(C_BATCH_SIZE);
+    }
+
+    appendLE32(reply, count);
+    for(uint done = 0; done < count; )
+    {
+        uint run = (count - done < C_BATCH_SIZE) ? count - done : C_BATCH_SIZE;
+        for(uint i = 0; i < run; i++, p += C_SRV_RECORD)
+        {
+            batch[i].address = getLE64(p);
+            batch[i].size = getLE32(p + 8);
+            batch[i].write = getLE32(p + 12) & 1;
+        }
+
+        resident.cache->access(batch.data(), run, false, wantStatus ? status.data() : NULL);
+        if(wantStatus)  {
+            reply.append((const char*) status.data(), run);
+        }
+        done += run;
+    }
+
+    return C_SRV_OK;
+}
+
+void Server::report(ResidentCache& resident)
+{
+    Cache* cache = resident.cache;
+    std::ostringstream out;
+
+    long long values[S_COUNT];
+    cache->snapshot(values);
+    if(resident.assoc != 0)  {
+        values[S_CAP] = 0;
+    }
+    for(int i = 0; i < S_PRINTED; i++)  {
+        out << values[i] << std::endl;
+    }
+    if(values[S_BLOCK] != values[S_ACCESS])  {
+        out << "split: " << values[S_ACCESS] << " accesses, " << values[S_BLOCK] << " block accesses" << std::endl;
+    }
+
+    cache->reportOccupancy(out, "sets: ");
+    if(resident.sectorSize > 0)  {
+        cache->reportTraffic(out, "sectors: ");
+    }
+
+    reply += out.str();
+}
@@ -0,0 +1,106 @@
+#ifndef CACHEMAN_SERVER_H
+#define CACHEMAN_SERVER_H
+
+#include "cache.h"
+
+#include <map>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Simulation daemon: named caches kept resident behind a Unix domain socket
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+// Server protocol: every request is a little-endian frame
+//      u32 length of the rest, u8 op, payload
+// and gets one reply frame
+//      u32 length of the rest, u8 C_SRV_* status, payload
+// Names are u8 length + bytes. Several clients may be connected; frames are handled one at a
+// time in arrival order, so clients feeding the same cache interleave at frame granularity
+#define C_SRV_CREATE 1  //name, u32 cache size, block size, assoc, policy, addr bits (0: default),
+                        //index function, sector size (0: none) -> nothing
+#define C_SRV_ACCESS 2  //name, u8 want status, then C_SRV_RECORD-byte records
+                        //(u64 address, u32 size up to C_ACCESS_MAX, u32 flags, bit 0: write)
+                        //-> u32 accesses, and with want status a C_HIT/C_MISS_* byte per access
+#define C_SRV_STATS  3  //name -> u32 field count, u64 fields by S_* slot (see cacheStatDefs)
+#define C_SRV_REPORT 4  //name -> text: the totals as main() prints them, occupancy, sector traffic
+#define C_SRV_RESET  5  //name -> nothing; the cache is rebuilt empty with the same parameters
+#define C_SRV_DROP   6  //name -> nothing
+#define C_SRV_LIST   7  //nothing -> names, one per line
+
+#define C_SRV_OK      0
+#define C_SRV_UNKNOWN 1     //no cache by that name
+#define C_SRV_EXISTS  2     //C_SRV_CREATE of a name in use
+#define C_SRV_INVALID 3     //malformed frame or bad parameters
+
+#define C_SRV_RECORD 16
+#define C_SRV_FRAME_MAX (64 << 20)  //longer frames close the connection
+#define C_SRV_READ (1 << 16)        //bytes read from a client at a time
+#define C_SRV_OUT_MAX (4 << 20)     //unsent reply bytes past which a client's frames wait
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : Server
+*    Application        : Keeps named Caches resident and serves the C_SRV_* protocol on a Unix
+*                         socket, so tracers stream batches into them without re-reading a config
+*                         or rebuilding sets per query; single-threaded, poll() over all clients.
+*                         Client sockets are non-blocking and replies queue per client, so one
+*                         client that stops reading only stalls itself
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//one resident cache and what it was created with
+typedef struct ResidentCachest
+{
+    Memory*  memory = NULL;
+    Cache*   cache  = NULL;
+    int  cacheSize = 0, blockSize = 0, assoc = 0, policy = 0;
+    int  addrBits = C_ADDR_BITS, indexFunc = C_IDX_MODULO;
+    uint sectorSize = 0;
+}  ResidentCache;
+
+//one connection, the bytes received but not yet handled and the replies not yet sent
+typedef struct Clientst
+{
+    int  fd = -1;
+    std::vector<char> in;
+    std::string out;
+    size_t sent = 0;    //bytes of <out> already sent
+}  Client;
+
+class Server
+{
+private:
+    std::string path;
+    int listenFd = -1;
+    std::vector<Client> clients;
+    std::map<std::string, ResidentCache> caches;
+
+    //reused by every request, so a batch costs no allocation once they have grown
+    std::vector<Access> batch;
+    std::vector<unsigned char> status;
+    std::string reply;
+
+    //builds the Cache of <resident> from its parameters, dropping any old one
+    void build(ResidentCache& resident);
+    void destroy(ResidentCache& resident);
+
+    //handles one frame, leaving the reply payload in <reply>; returns a C_SRV_* status
+    int handle(const char* frame, uint length);
+    int access(ResidentCache& resident, const char* p, const char* end);
+    void report(ResidentCache& resident);
+
+    //reads what <client> sent, false once it should be closed
+    bool receive(Client& client);
+    //answers the complete frames received, while the queued replies stay under C_SRV_OUT_MAX
+    bool answer(Client& client);
+    //sends what the socket takes of the queued replies, false once it should be closed
+    bool send(Client& client);
+public:
+    ~Server();
+
+    //binds and listens on <path>, replacing a stale socket file
+    bool open(const std::string& path);
+    //serves until SIGINT or SIGTERM
+    void run();
+};
+
+#endif
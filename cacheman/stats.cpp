@@ -0,0 +1,885 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Sampling, interval series, reuse-distance and per-pc profiling
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//////////////////////////////////////////////////////////////////////
+///////////////////////   SAMPLER DEFINITIONS   //////////////////////
+//////////////////////////////////////////////////////////////////////
+
+Sampler::Sampler(Cache* cR, uint period, uint window, uint warmup)
+{
+    this->cacheRef = cR;
+    this->period = period;
+    this->window = window;
+    this->warmup = warmup;
+
+    //window and warmup are clamped into the period
+    if(this->window > period)  {
+        this->window = period;
+    }
+    if(this->warmup > period - this->window)  {
+        this->warmup = period - this->window;
+    }
+
+    windowStart = period - this->window;
+    warmEnd = windowStart - this->warmup;
+}
+
+void Sampler::access(const Access* accesses, uint count)
+{
+    while(count > 0)
+    {
+        //length of the run up to the next phase boundary
+        uint run;
+        if(position < warmEnd)  {
+            run = warmEnd - position;
+        }
+        else if(position < windowStart)  {
+            run = windowStart - position;
+        }
+        else  {
+            if(position == windowStart)  {
+                cacheRef->snapshot(windowStats);
+            }
+            run = period - position;
+        }
+        if(run > count)  {
+            run = count;
+        }
+
+        if(position < warmEnd)
+        {
+            //fast-forward: tag and replacement state only
+            for(uint i = 0; i < run; i++)  {
+                if(!accesses[i].fetch)  {
+                    cacheRef->warm(accesses[i]);
+                }
+            }
+        }
+        else
+        {
+            cacheRef->access(accesses, run);
+        }
+
+        //instruction fetches belong to the I-cache and are not counted here
+        for(uint i = 0; i < run; i++)  {
+            if(accesses[i].fetch)       {continue;}
+            else if(accesses[i].write)  {totalWrite++;}
+            else                        {totalRead++;}
+        }
+        totalAccess = totalRead + totalWrite;
+
+        accesses += run;
+        count -= run;
+        position += run;
+
+        if(position == period)
+        {
+            //window complete: accumulate its deltas
+            long long now[S_COUNT];
+            cacheRef->snapshot(now);
+            for(int i = 0; i < S_COUNT; i++)  {
+                measured[i] += now[i] - windowStats[i];
+            }
+
+            long long windowAccesses = now[S_ACCESS] - windowStats[S_ACCESS];
+            long long windowMisses   = now[S_MISS] - windowStats[S_MISS];
+            if(windowAccesses > 0)  {
+                windowMissRatio.push_back((double) windowMisses / windowAccesses);
+            }
+
+            position = 0;
+        }
+    }
+}
+
+void Sampler::estimate(long long* values, bool fullyAssoc)
+{
+    //scale measured window stats up to the whole trace
+    double scale = 0;
+    if(measured[S_ACCESS] > 0)  {
+        scale = (double) totalAccess / measured[S_ACCESS];
+    }
+
+    for(int i = 0; i < S_COUNT; i++)  {
+        values[i] = llround(measured[i] * scale);
+    }
+    values[S_ACCESS] = totalAccess;
+    values[S_READ]   = totalRead;
+    values[S_WRITE]  = totalWrite;
+    if(!fullyAssoc)  {
+        values[S_CAP] = 0;
+    }
+}
+
+double Sampler::getConfidence(double& mean, double& var)
+{
+    size_t n = windowMissRatio.size();
+    mean = 0;
+    var = 0;
+    for(size_t i = 0; i < n; i++)  {
+        mean += windowMissRatio[i];
+    }
+    if(n > 0)  {
+        mean /= n;
+    }
+    for(size_t i = 0; i < n; i++)  {
+        var += (windowMissRatio[i] - mean) * (windowMissRatio[i] - mean);
+    }
+    if(n > 1)  {
+        var /= (n - 1);
+    }
+    return (n > 1) ? 1.96 * sqrt(var / n) : 0;
+}
+
+void Sampler::report(std::ostream& out, double errorBound)
+{
+    if(measured[S_ACCESS] == 0)  {
+        std::cerr << "warning: trace ended before the first sampling window completed" << std::endl;
+    }
+
+    //95% confidence interval on the miss ratio from the per-window samples
+    size_t n = windowMissRatio.size();
+    double mean, var;
+    double halfWidth = getConfidence(mean, var);
+
+    out << "sampling: " << n << " windows of " << window << " accesses, period " << period
+        << ", warmup " << warmup << std::endl;
+    out << "sampling: measured " << measured[S_ACCESS] << " of " << totalAccess << " accesses" << std::endl;
+    out << "sampling: miss ratio " << mean << " +- " << halfWidth << " (95% confidence)" << std::endl;
+    long long totals[S_COUNT];
+    estimate(totals, true);
+    out << "sampling: misses " << totals[S_MISS] << " +- " << llround(halfWidth * totalAccess) << std::endl;
+
+    //relative error against the requested bound
+    if(mean > 0 && n > 1)
+    {
+        double relError = halfWidth / mean;
+        out << "sampling: relative error " << relError << " (bound " << errorBound << ")" << std::endl;
+        if(relError > errorBound)
+        {
+            //windows needed for the bound: n = (z * s / (e * mean))^2
+            double needed = 1.96 * sqrt(var) / (errorBound * mean);
+            out << "sampling: error bound not met, need about " << (long long) ceil(needed * needed)
+                << " windows" << std::endl;
+        }
+    }
+}
+
+void Sampler::exportStats(StatGroup& group)
+{
+    double mean, var;
+    double halfWidth = getConfidence(mean, var);
+
+    addStat(group, "windows", (long long) windowMissRatio.size(), "windows", "measurement windows completed");
+    addStat(group, "window", (long long) window, "accesses", "accesses measured per window");
+    addStat(group, "period", (long long) period, "accesses", "accesses from one window to the next");
+    addStat(group, "warmup", (long long) warmup, "accesses", "detailed accesses before each window");
+    addStat(group, "measured_accesses", measured[S_ACCESS], "accesses", "accesses inside the windows");
+    //undefined without windows, and the interval without two of them
+    size_t n = windowMissRatio.size();
+    addStat(group, "miss_ratio", (n > 0) ? mean : NAN, "ratio", "mean miss ratio of the windows");
+    addStat(group, "miss_ratio_half_width", (n > 1) ? halfWidth : NAN, "ratio",
+            "95% confidence half-width of the miss ratio");
+}
+
+//////////////////////////////////////////////////////////////////////
+/////////////////////     REUSE DEFINITIONS      /////////////////////
+//////////////////////////////////////////////////////////////////////
+
+StackDistance::StackDistance(uint span)
+{
+    tree.assign(span + 1, 0);
+    blockAt.resize(span);
+    live.assign(span, false);
+}
+
+void StackDistance::add(uint time, int delta)
+{
+    for(uint i = time + 1; i < tree.size(); i += i & (~i + 1))  {
+        tree[i] += delta;
+    }
+}
+
+uint StackDistance::prefix(uint time)
+{
+    uint sum = 0;
+    for(uint i = time + 1; i > 0; i -= i & (~i + 1))  {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void StackDistance::compact()
+{
+    //renumber the live timestamps 0..k-1 in order, keeping the distances
+    uint k = 0;
+    for(uint t = 0; t < now; t++)  {
+        if(live[t])  {
+            blockAt[k] = blockAt[t];
+            lastUse[blockAt[k]] = k;
+            k++;
+        }
+    }
+
+    //grow once live blocks take over half the span
+    uint span = blockAt.size();
+    if(k > span / 2)  {
+        span *= 2;
+    }
+    blockAt.resize(span);
+    live.assign(span, false);
+    tree.assign(span + 1, 0);
+
+    //linear Fenwick build: push each node's sum up to its parent, across the
+    //whole span since nodes past k still carry their children's counts
+    for(uint j = 1; j <= span; j++)  {
+        if(j <= k)  {
+            live[j - 1] = true;
+            tree[j] += 1;
+        }
+        uint parent = j + (j & (~j + 1));
+        if(parent <= span)  {
+            tree[parent] += tree[j];
+        }
+    }
+    now = k;
+}
+
+long long StackDistance::access(addr_t block)
+{
+    if(now == blockAt.size())  {
+        compact();
+    }
+
+    long long distance = -1;
+    std::unordered_map<addr_t, uint>::iterator it = lastUse.find(block);
+    if(it != lastUse.end())
+    {
+        uint last = it->second;
+        distance = (now > 0 ? prefix(now - 1) : 0) - prefix(last);
+        add(last, -1);
+        live[last] = false;
+        it->second = now;
+    }
+    else
+    {
+        lastUse[block] = now;
+    }
+
+    add(now, 1);
+    live[now] = true;
+    blockAt[now] = block;
+    now++;
+
+    return distance;
+}
+
+ReuseProfiler::ReuseProfiler(Cache* cR, bool perSetMode)
+{
+    this->cacheRef = cR;
+    this->offsetLength = log2((uint) cR->getBlockSize());
+
+    //per-set state is only made for the sets the trace touches
+    if(perSetMode)  {
+        perSet.assign(cR->getNumSets(), NULL);
+    }
+}
+
+ReuseProfiler::~ReuseProfiler()
+{
+    for(size_t set = 0; set < perSet.size(); set++)  {
+        delete perSet[set];
+    }
+}
+
+int ReuseProfiler::bin(long long distance)
+{
+    int k = 0;
+    while(distance > 0)  {
+        distance >>= 1;
+        k++;
+    }
+    return k;
+}
+
+void ReuseProfiler::access(const Access* accesses, uint count)
+{
+    for(uint i = 0; i < count; i++)
+    {
+        if(accesses[i].fetch)  {
+            continue;
+        }
+
+        addr_t block = accesses[i].address >> offsetLength;
+        long long distance = global.access(block);
+        if(distance < 0)  {cold++;}
+        else              {hist[bin(distance)]++;}
+
+        if(!perSet.empty())
+        {
+            uint set = cacheRef->getIndex(accesses[i].address);
+            if(perSet[set] == NULL)  {
+                perSet[set] = new SetReuse();
+            }
+            distance = perSet[set]->distance.access(block);
+            if(distance < 0)  {perSet[set]->cold++;}
+            else              {perSet[set]->hist[bin(distance)]++;}
+        }
+    }
+}
+
+void ReuseProfiler::printHistogram(std::ostream& out, const char* prefix, unsigned long long cold,
+                                   const unsigned long long* hist)
+{
+    //cold count, then the bins up to the last non-empty one
+    int last = C_REUSE_BINS - 1;
+    while(last >= 0 && hist[last] == 0)  {
+        last--;
+    }
+
+    out << prefix << "cold " << cold;
+    for(int k = 0; k <= last; k++)  {
+        out << " " << hist[k];
+    }
+    out << std::endl;
+}
+
+void ReuseProfiler::report(std::ostream& out)
+{
+    //bin k holds distances in [2^(k-1), 2^k), bin 0 distance 0
+    printHistogram(out, "reuse: ", cold, hist);
+
+    if(perSet.empty())  {
+        return;
+    }
+
+    //all sets together: an LRU set of A ways hits exactly the distances below A
+    unsigned long long total[C_REUSE_BINS] = {};
+    unsigned long long totalCold = 0;
+    for(size_t set = 0; set < perSet.size(); set++)
+    {
+        if(perSet[set] == NULL)  {
+            continue;
+        }
+        totalCold += perSet[set]->cold;
+        for(int k = 0; k < C_REUSE_BINS; k++)  {
+            total[k] += perSet[set]->hist[k];
+        }
+    }
+    printHistogram(out, "reuse-sets: ", totalCold, total);
+
+    //sets never accessed print as empty
+    unsigned long long none[C_REUSE_BINS] = {};
+    for(size_t set = 0; set < perSet.size(); set++)
+    {
+        std::string prefix = "reuse-set " + std::to_string(set) + ": ";
+        if(perSet[set] == NULL)  {
+            printHistogram(out, prefix.c_str(), 0, none);
+        }
+        else  {
+            printHistogram(out, prefix.c_str(), perSet[set]->cold, perSet[set]->hist);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/////////////////////       PC DEFINITIONS       /////////////////////
+//////////////////////////////////////////////////////////////////////
+
+PcProfiler::PcProfiler()
+{
+    table.resize(C_PC_SLOTS);
+}
+
+PcStat& PcProfiler::find(addr_t pc)
+{
+    //linear probing from a multiplicative hash
+    size_t mask = table.size() - 1;
+    size_t slot = (pc * 0x9E3779B97F4A7C15ULL) >> 32 & mask;
+    while(table[slot].pc != pc && table[slot].pc != 0)  {
+        slot = (slot + 1) & mask;
+    }
+
+    if(table[slot].pc == 0)
+    {
+        if(2 * (used + 1) > table.size())  {
+            grow();
+            return find(pc);
+        }
+        table[slot].pc = pc;
+        used++;
+    }
+    return table[slot];
+}
+
+void PcProfiler::grow()
+{
+    std::vector<PcStat> old;
+    old.swap(table);
+    table.resize(old.size() * 2);
+    used = 0;
+
+    for(size_t i = 0; i < old.size(); i++)  {
+        if(old[i].pc != 0)  {
+            PcStat& moved = find(old[i].pc);
+            moved = old[i];
+        }
+    }
+}
+
+void PcProfiler::account(const Access* accesses, const unsigned char* status, uint count)
+{
+    for(uint i = 0; i < count; i++)
+    {
+        if(accesses[i].fetch || accesses[i].walk || status[i] == C_SKIPPED)  {
+            continue;
+        }
+
+        PcStat& stat = (accesses[i].pc != 0) ? find(accesses[i].pc) : unknown;
+        stat.accesses++;
+        if(status[i] != C_HIT)  {
+            stat.misses++;
+        }
+        if(status[i] == C_MISS_DIR)  {
+            stat.dirty++;
+        }
+    }
+}
+
+std::vector<PcStat> PcProfiler::getWorst(uint top)
+{
+    std::vector<PcStat> worst;
+    for(size_t i = 0; i < table.size(); i++)  {
+        if(table[i].pc != 0)  {
+            worst.push_back(table[i]);
+        }
+    }
+
+    size_t shown = (worst.size() < top) ? worst.size() : top;
+    std::partial_sort(worst.begin(), worst.begin() + shown, worst.end(),
+                      [](const PcStat& a, const PcStat& b)  {return a.misses > b.misses;});
+    worst.resize(shown);
+    return worst;
+}
+
+void PcProfiler::report(std::ostream& out, uint top)
+{
+    std::vector<PcStat> worst = getWorst(top);
+
+    out << "pc: " << used << " pcs";
+    if(unknown.accesses > 0)  {
+        out << ", " << unknown.accesses << " accesses without one";
+    }
+    out << std::endl;
+
+    for(size_t k = 0; k < worst.size(); k++)
+    {
+        const PcStat& stat = worst[k];
+        char pc[C_TRAC_HEX_LEN + 3];
+        snprintf(pc, sizeof(pc), "0x%llx", stat.pc);
+        out << "pc: " << pc << " accesses " << stat.accesses << " hits " << stat.accesses - stat.misses
+            << " misses " << stat.misses << " dirty " << stat.dirty
+            << " miss-ratio " << (double) stat.misses / stat.accesses << std::endl;
+    }
+}
+
+void PcProfiler::exportStats(StatGroup& group, uint top)
+{
+    addStat(group, "pcs", (long long) used, "pcs", "distinct pcs seen");
+    addStat(group, "accesses_without_pc", (long long) unknown.accesses, "accesses", "accesses the trace gave no pc");
+
+    //the delinquent loads, keyed by pc
+    std::vector<PcStat> worst = getWorst(top);
+    for(size_t k = 0; k < worst.size(); k++)
+    {
+        char pc[C_TRAC_HEX_LEN + 3];
+        snprintf(pc, sizeof(pc), "0x%llx", worst[k].pc);
+        std::string key = pc;
+        addStat(group, key + "_accesses", (long long) worst[k].accesses, "accesses", "accesses by this pc");
+        addStat(group, key + "_misses", (long long) worst[k].misses, "misses", "misses of this pc");
+        addStat(group, key + "_dirty", (long long) worst[k].dirty, "misses", "misses of this pc that evicted a dirty block");
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+///////////////////////   INTERVAL DEFINITIONS   /////////////////////
+//////////////////////////////////////////////////////////////////////
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+    if(owned)  {
+        close(fd);
+    }
+}
+
+bool BufferedWriter::open(const std::string& path)
+{
+    if(path == "-")  {
+        fd = STDOUT_FILENO;
+        return true;
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)  {
+        std::cerr << "cannot write " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    owned = true;
+    return true;
+}
+
+void BufferedWriter::put(const char* data, size_t length)
+{
+    if(used + length > sizeof(buffer))  {
+        flush();
+    }
+    if(length > sizeof(buffer))  {
+        //too big to buffer, straight through
+        if(::write(fd, data, length) != (ssize_t) length)  {
+            failed = true;
+        }
+        return;
+    }
+    memcpy(buffer + used, data, length);
+    used += length;
+}
+
+void BufferedWriter::putDecimal(long long value)
+{
+    char digits[24];
+    int n = sizeof(digits);
+    unsigned long long v = (value < 0) ? -(unsigned long long) value : value;
+    do  {
+        digits[--n] = '0' + v % 10;
+        v /= 10;
+    }  while(v != 0);
+    if(value < 0)  {
+        digits[--n] = '-';
+    }
+    put(digits + n, sizeof(digits) - n);
+}
+
+void BufferedWriter::putLE64(unsigned long long value)
+{
+    char bytes[8];
+    for(int i = 0; i < 8; i++)  {
+        bytes[i] = (char) (value >> (8 * i));
+    }
+    put(bytes, 8);
+}
+
+void BufferedWriter::putLE32(uint value)
+{
+    char bytes[4];
+    for(int i = 0; i < 4; i++)  {
+        bytes[i] = (char) (value >> (8 * i));
+    }
+    put(bytes, 4);
+}
+
+bool BufferedWriter::flush()
+{
+    size_t done = 0;
+    while(done < used && fd >= 0)
+    {
+        ssize_t n = ::write(fd, buffer + done, used - done);
+        if(n < 0 && errno == EINTR)  {
+            continue;
+        }
+        if(n <= 0)  {
+            failed = true;
+            break;
+        }
+        done += n;
+    }
+    used = 0;
+    return !failed;
+}
+
+IntervalReporter::IntervalReporter(Cache* cR, BufferedWriter& out, unsigned long long interval, int format)
+    : out(out)
+{
+    this->cacheRef = cR;
+    this->interval = interval;
+    this->format = format;
+
+    if(format == C_SERIES_CSV)
+    {
+        out.put("processed");
+        for(int i = 0; i < S_COUNT; i++)  {
+            out.put(",");
+            out.put(cacheStatDefs[i].name);
+        }
+        out.put("\n");
+    }
+    else if(format == C_SERIES_BIN)
+    {
+        //magic, version, then fields per record: accesses so far and the deltas
+        out.put(C_SERIES_BIN_MAGIC, 4);
+        out.putLE32(1);
+        out.putLE32(1 + S_COUNT);
+    }
+}
+
+void IntervalReporter::print()
+{
+    long long now[S_COUNT];
+    cacheRef->snapshot(now);
+
+    //one record per interval: accesses so far, then deltas in main()'s order
+    if(format == C_SERIES_BIN)
+    {
+        out.putLE64(processed);
+        for(int i = 0; i < S_COUNT; i++)  {
+            out.putLE64(now[i] - lastStats[i]);
+            lastStats[i] = now[i];
+        }
+        return;
+    }
+
+    const char* separator = (format == C_SERIES_CSV) ? "," : " ";
+    if(format == C_SERIES_TEXT)  {
+        out.put("interval: ");
+    }
+    out.putDecimal(processed);
+    for(int i = 0; i < S_COUNT; i++)  {
+        out.put(separator, 1);
+        out.putDecimal(now[i] - lastStats[i]);
+        lastStats[i] = now[i];
+    }
+    out.put("\n", 1);
+}
+
+void IntervalReporter::advance(uint count)
+{
+    processed += count;
+    position += count;
+
+    if(position == interval)  {
+        print();
+        position = 0;
+    }
+}
+
+void IntervalReporter::finish()
+{
+    if(position > 0)  {
+        print();
+        position = 0;
+    }
+    out.flush();
+}
+
+//////////////////////////////////////////////////////////////////////
+///////////////////     PROGRESS DEFINITIONS     /////////////////////
+//////////////////////////////////////////////////////////////////////
+
+//resident set size of this process in bytes, -1 where /proc is missing
+static long long residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    long long size, resident;
+    if(!(statm >> size >> resident))  {
+        return -1;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+//h:mm:ss
+static std::string formatDuration(double seconds)
+{
+    long long s = llround(seconds);
+    char text[32];
+    snprintf(text, sizeof(text), "%lld:%02lld:%02lld", s / 3600, (s / 60) % 60, s % 60);
+    return text;
+}
+
+ProgressReporter::ProgressReporter(double period, bool toStderr, const std::string& statusPath)
+{
+    this->period = period;
+    this->toStderr = toStderr;
+    this->statusPath = statusPath;
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    //left early: stop the thread without a final report
+    if(worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+}
+
+void ProgressReporter::start(const std::atomic<unsigned long long>* position, unsigned long long total)
+{
+    this->position = position;
+    this->total = total;
+    started = lastTime = std::chrono::steady_clock::now();
+    worker = std::thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while(!wake.wait_for(guard, std::chrono::duration<double>(period), [this]  {return stopping;}))  {
+        print(false);
+    }
+}
+
+void ProgressReporter::print(bool done)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - started).count();
+    double span = std::chrono::duration<double>(now - lastTime).count();
+    unsigned long long count = accesses.load(std::memory_order_relaxed);
+
+    //over the last period while running, over the whole run at the end
+    double rate = 0;
+    if(done)  {
+        rate = (elapsed > 0) ? count / elapsed : 0;
+    }
+    else if(span > 0)  {
+        rate = (count - lastAccesses) / span;
+    }
+    lastTime = now;
+    lastAccesses = count;
+
+    //share done and time left, -1 when unknown
+    double share = -1, eta = -1;
+    if(position != NULL && total > 0)
+    {
+        share = done ? 1.0 : std::min(1.0, (double) position->load(std::memory_order_relaxed) / total);
+        if(share > 0)  {
+            eta = elapsed * (1 - share) / share;
+        }
+    }
+    long long rss = residentBytes();
+
+    if(toStderr)
+    {
+        //one write, so the line does not interleave with other messages
+        std::ostringstream line;
+        line << "progress: " << (done ? "done " : "");
+        if(share >= 0)  {line << std::fixed << std::setprecision(1) << share * 100 << "% ";}
+        line << count << " accesses " << (long long) rate << "/s";
+        if(done)              {line << " in " << formatDuration(elapsed);}
+        else if(eta >= 0)     {line << " eta " << formatDuration(eta);}
+        if(rss >= 0)          {line << " rss " << (rss >> 20) << " MiB";}
+        std::cerr << line.str() << std::endl;
+    }
+
+    if(!statusPath.empty())
+    {
+        //rewritten under another name and renamed, so readers never see half a file
+        std::string temp = statusPath + ".tmp";
+        std::ofstream status(temp.c_str());
+        status << "{\"state\": \"" << (done ? "done" : "running") << "\", \"elapsed\": " << elapsed
+               << ", \"accesses\": " << count << ", \"share\": ";
+        if(share >= 0)  {status << share;}  else  {status << "null";}
+        status << ", \"rate\": " << (long long) rate << ", \"eta\": ";
+        if(eta >= 0)    {status << eta;}    else  {status << "null";}
+        status << ", \"rss\": " << rss << "}" << std::endl;
+        status.close();
+        if(!status || rename(temp.c_str(), statusPath.c_str()) != 0)  {
+            std::cerr << "cannot write status file " << statusPath << std::endl;
+        }
+    }
+}
+
+void ProgressReporter::finish()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if(worker.joinable())  {
+        worker.join();
+    }
+    print(true);
+}
+
+//////////////////////////////////////////////////////////////////////
+////////////////////      EXPORT DEFINITIONS      ////////////////////
+//////////////////////////////////////////////////////////////////////
+
+void writeStats(std::ostream& out, int format, const std::vector<StatGroup>& groups)
+{
+    if(format == C_STATS_JSON)
+    {
+        out << "{" << std::endl;
+        for(size_t g = 0; g < groups.size(); g++)
+        {
+            const std::vector<StatValue>& values = groups[g].values;
+            out << "  \"" << groups[g].name << "\": {" << std::endl;
+            for(size_t i = 0; i < values.size(); i++)
+            {
+                out << "    \"" << values[i].name << "\": {\"value\": "
+                    << (values[i].value.empty() ? "null" : values[i].value)
+                    << ", \"unit\": \"" << values[i].unit << "\", \"description\": \"" << values[i].description << "\"}"
+                    << (i + 1 < values.size() ? "," : "") << std::endl;
+            }
+            out << "  }" << (g + 1 < groups.size() ? "," : "") << std::endl;
+        }
+        out << "}" << std::endl;
+    }
+    else if(format == C_STATS_CSV)
+    {
+        out << "group,name,value,unit,description" << std::endl;
+        for(size_t g = 0; g < groups.size(); g++)  {
+            for(size_t i = 0; i < groups[g].values.size(); i++)  {
+                const StatValue& stat = groups[g].values[i];
+                out << groups[g].name << "," << stat.name << "," << stat.value << ","
+                    << stat.unit << ",\"" << stat.description << "\"" << std::endl;
+            }
+        }
+    }
+    else if(format == C_STATS_TABLE)
+    {
+        //column widths from the longest name, value and unit
+        size_t nameWidth = 0, valueWidth = 0, unitWidth = 0;
+        for(size_t g = 0; g < groups.size(); g++)  {
+            for(size_t i = 0; i < groups[g].values.size(); i++)  {
+                const StatValue& stat = groups[g].values[i];
+                nameWidth = std::max(nameWidth, stat.name.size());
+                valueWidth = std::max(valueWidth, std::max(stat.value.size(), (size_t) 1));
+                unitWidth = std::max(unitWidth, strlen(stat.unit));
+            }
+        }
+
+        for(size_t g = 0; g < groups.size(); g++)
+        {
+            out << groups[g].name << std::endl;
+            for(size_t i = 0; i < groups[g].values.size(); i++)
+            {
+                const StatValue& stat = groups[g].values[i];
+                out << "  " << std::left << std::setw(nameWidth) << stat.name
+                    << "  " << std::right << std::setw(valueWidth) << (stat.value.empty() ? "-" : stat.value)
+                    << "  " << std::left << std::setw(unitWidth) << stat.unit << "  " << stat.description
+                    << std::right << std::endl;
+            }
+        }
+    }
+}
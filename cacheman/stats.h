@@ -0,0 +1,308 @@
+#ifndef CACHEMAN_STATS_H
+#define CACHEMAN_STATS_H
+
+#include "cache.h"
+
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Stats around a Cache: sampling, interval series, reuse distance and per-pc profiles
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+// Reports
+#define C_REUSE_BINS 65 //log2 bins of a reuse-distance histogram: 0, then [2^(k-1), 2^k)
+#define C_REUSE_SPAN 1024   //initial timestamps in a StackDistance, doubled as needed
+#define C_REUSE_SET_SPAN 16 //same for each set's, made on the set's first access
+#define C_PC_SLOTS 1024     //initial PcProfiler table size (power of 2), doubled at half full
+
+// Interval series formats
+#define C_SERIES_TEXT 0     //"interval: <accesses so far> <deltas>" lines
+#define C_SERIES_CSV  1     //header, then one row per interval
+#define C_SERIES_BIN  2     //C_SERIES_BIN_MAGIC header, then little-endian 64-bit records
+
+#define C_SERIES_BIN_MAGIC "CMIV"   //then 32-bit version and 32-bit fields per record
+#define C_SERIES_BUFFER (1 << 16)   //BufferedWriter buffer size
+
+// Stats export formats (see writeStats)
+#define C_STATS_TEXT  0     //bare numbers in main()'s order, as always printed
+#define C_STATS_JSON  1     //{"group": {"name": {"value", "unit", "description"}}}, value null if undefined
+#define C_STATS_CSV   2     //group,name,value,unit,description rows under a header, value empty if undefined
+#define C_STATS_TABLE 3     //aligned columns for people
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : Sampler
+*    Application        : SMARTS-style sampled simulation of a Cache; alternates functional
+*                         warming with detailed measurement windows and extrapolates the stats
+*                         (compulsory misses read high: warming skips the first-touch set)
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class Sampler
+{
+private:
+    Cache* cacheRef;
+
+    //every <period> accesses: (period - warmup - window) warmed, <warmup> detailed
+    //but unmeasured, then <window> measured
+    uint period;
+    uint window;
+    uint warmup;
+    uint warmEnd;       //position in period where detailed warmup begins
+    uint windowStart;   //position in period where the window begins
+    uint position = 0;  //position in current period
+
+    //exact counts over the whole trace
+    long long totalAccess = 0;
+    long long totalRead = 0;
+    long long totalWrite = 0;
+
+    //summed stat deltas of completed windows, and the stats at window start
+    long long measured[S_COUNT] = {};
+    long long windowStats[S_COUNT];
+
+    //miss ratio of each completed window, for the confidence interval
+    std::vector<double> windowMissRatio;
+
+    //mean and sample variance of the window miss ratios; returns the 95% half-width
+    double getConfidence(double& mean, double& var);
+public:
+    Sampler(Cache* cR, uint period, uint window, uint warmup);
+
+    //splits the batch at phase boundaries; detailed phases go through Cache::access()
+    void access(const Access* accesses, uint count);
+
+    //stats scaled up from the windows to the whole trace, into values[S_COUNT]
+    void estimate(long long* values, bool fullyAssoc);
+    //prints the sampling report: windows, miss ratio and its confidence interval
+    //errorBound: target relative half-width of the 95% interval on the miss ratio
+    void report(std::ostream& out, double errorBound);
+    void exportStats(StatGroup& group);
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Function Name : writeStats
+*    Application   : Dumps named groups of stats (the Cache counters by cacheStatDefs, and what
+*                    each model exports) with their unit and description, as JSON, CSV or an
+*                    aligned table (C_STATS_*)
+-------------------------------------------------------------------------------------------------*/
+void writeStats(std::ostream& out, int format, const std::vector<StatGroup>& groups);
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : BufferedWriter
+*    Application        : Appends to a file descriptor through one fixed buffer, so streaming
+*                         output costs a write() per C_SERIES_BUFFER bytes and no allocation
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class BufferedWriter
+{
+private:
+    int fd = -1;
+    bool owned = false;     //opened here, closed here
+    bool failed = false;
+    size_t used = 0;
+    char buffer[C_SERIES_BUFFER];
+public:
+    ~BufferedWriter();
+
+    //"-" for stdout, else the file is created or truncated
+    bool open(const std::string& path);
+
+    void put(const char* data, size_t length);
+    void put(const char* text)  {put(text, strlen(text));}
+    void putDecimal(long long value);
+    void putLE64(unsigned long long value);
+    void putLE32(uint value);
+
+    //false once any write has failed
+    bool flush();
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : IntervalReporter
+*    Application        : Appends the stat deltas of a Cache every <interval> accesses to a time
+*                         series while the trace is still flowing (C_SERIES_* formats)
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class IntervalReporter
+{
+private:
+    Cache* cacheRef;
+    BufferedWriter& out;
+    int format;
+
+    unsigned long long interval;
+    unsigned long long processed = 0;   //accesses so far
+    unsigned long long position = 0;    //accesses into the current interval
+
+    long long lastStats[S_COUNT] = {};  //stats at the previous report
+
+    void print();
+public:
+    //writes the CSV or binary header straight away
+    IntervalReporter(Cache* cR, BufferedWriter& out, unsigned long long interval, int format);
+
+    //accesses left before the next report is due
+    unsigned long long remaining()  {return interval - position;}
+    //accounts for <count> accesses (never more than remaining()), reporting when due
+    void advance(uint count);
+    //reports the trailing partial interval, if any
+    void finish();
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : ProgressReporter
+*    Application        : Reports how far a long run has got from its own thread, every <period>
+*                         seconds: share done (bytes of a mapped trace, or accesses of a generated
+*                         one), accesses per second over the last period, ETA and resident set
+*                         size, as a line on stderr and/or rewritten whole into a status file.
+*                         The simulation loop only bumps a relaxed atomic once per batch
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class ProgressReporter
+{
+private:
+    double period;
+    bool toStderr;
+    std::string statusPath;
+
+    std::atomic<unsigned long long> accesses{0};
+    const std::atomic<unsigned long long>* position = NULL;     //measured against <total>
+    unsigned long long total = 0;                               //0: share unknown
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::chrono::steady_clock::time_point started, lastTime;
+    unsigned long long lastAccesses = 0;
+
+    //reporter thread body
+    void run();
+    //one report; <done>: the run is over
+    void print(bool done);
+public:
+    ProgressReporter(double period, bool toStderr, const std::string& statusPath);
+    ~ProgressReporter();
+
+    //starts the reporter thread; <position> of <total> is the share done, NULL if unknown
+    void start(const std::atomic<unsigned long long>* position, unsigned long long total);
+    const std::atomic<unsigned long long>* getAccesses()  {return &accesses;}
+
+    //accounts for <count> more accesses, from the simulation thread only
+    inline void advance(uint count)
+    {
+        accesses.store(accesses.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    //stops the thread and makes the final report
+    void finish();
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : StackDistance, ReuseProfiler
+*    Application        : Reuse (LRU stack) distance of every data access, counted as the
+*                         distinct blocks touched since the block's previous access: a Fenwick
+*                         tree over access timestamps holds a 1 at each block's latest access,
+*                         so a distance is one prefix-sum difference, O(log n) per access.
+*                         Timestamps are renumbered in place when the span fills up.
+*                         ReuseProfiler keeps a log2-binned histogram over the whole trace and,
+*                         in per-set mode, one per set of the Cache's index function.
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class StackDistance
+{
+private:
+    std::unordered_map<addr_t, uint> lastUse;   //block -> timestamp of its latest access
+    std::vector<uint> tree;     //Fenwick tree over timestamps, 1-based
+    std::vector<addr_t> blockAt;    //timestamp -> block, for renumbering
+    std::vector<bool> live;         //timestamp is some block's latest access
+    uint now = 0;
+
+    void add(uint time, int delta);
+    uint prefix(uint time);     //live timestamps in [0, time]
+    void compact();
+public:
+    StackDistance(uint span = C_REUSE_SPAN);
+
+    //distance for <block> since its previous access, -1 on its first
+    long long access(addr_t block);
+};
+
+class ReuseProfiler
+{
+private:
+    Cache* cacheRef;
+    int offsetLength;
+
+    //one set's stack and histogram
+    typedef struct SetReusest
+    {
+        StackDistance distance;
+        unsigned long long hist[C_REUSE_BINS] = {};
+        unsigned long long cold = 0;
+
+        SetReusest() : distance(C_REUSE_SET_SPAN)  {}
+    }  SetReuse;
+
+    StackDistance global;
+    std::vector<SetReuse*> perSet;  //empty unless per-set, NULL for sets not accessed yet
+
+    unsigned long long hist[C_REUSE_BINS] = {};
+    unsigned long long cold = 0;
+
+    static int bin(long long distance);
+    static void printHistogram(std::ostream& out, const char* prefix, unsigned long long cold,
+                               const unsigned long long* hist);
+public:
+    ReuseProfiler(Cache* cR, bool perSetMode);
+    ~ReuseProfiler();
+
+    //data accesses only, fetches are skipped
+    void access(const Access* accesses, uint count);
+    void report(std::ostream& out);
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : PcProfiler
+*    Application        : Attributes data accesses, misses and dirty evictions to the instruction
+*                         (pc) that made them, in an open-addressed table keyed by pc, and lists
+*                         the delinquent loads: the pcs with the most misses
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+typedef struct PcStatst
+{
+    addr_t  pc = 0;     //0: empty slot
+    unsigned long long accesses = 0;
+    unsigned long long misses   = 0;
+    unsigned long long dirty    = 0;    //misses that evicted a dirty block
+}  PcStat;
+
+class PcProfiler
+{
+private:
+    std::vector<PcStat> table;
+    uint used = 0;
+    PcStat unknown;     //accesses without a pc
+
+    PcStat& find(addr_t pc);
+    void grow();
+    //the <top> pcs with the most misses, most first
+    std::vector<PcStat> getWorst(uint top);
+public:
+    PcProfiler();
+
+    //accounts the data accesses by their C_HIT/C_MISS_* status, as left by Cache::access
+    void account(const Access* accesses, const unsigned char* status, uint count);
+    //prints the <top> pcs with the most misses
+    void report(std::ostream& out, uint top);
+    void exportStats(StatGroup& group, uint top);
+};
+
+#endif
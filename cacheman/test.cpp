@@ -917,11 +917,13 @@ int main()
         else if(command == 'w')
             L1.write(std::stoi(hexCode,0,16), &buffer);
     }
+    //same fields, same order as cacheman prints them (see cacheStatDefs)
     std::cout << L1.stat_cache_access << std::endl;
     std::cout << L1.stat_cache_read<< std::endl;
     std::cout << L1.stat_cache_write<< std::endl;
+    std::cout << L1.stat_cache_miss << std::endl;
     std::cout << L1.stat_cache_miss_compulsory << std::endl;
-    std::cout << L1.stat_cache_miss_capacity << std::endl;
+    std::cout << (org == 0 ? L1.stat_cache_miss_capacity : 0) << std::endl;
     std::cout << L1.stat_cache_miss_conflict << std::endl;
     std::cout << L1.stat_cache_miss_read << std::endl;
     std::cout << L1.stat_cache_miss_write << std::endl;
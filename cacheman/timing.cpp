@@ -0,0 +1,314 @@
+#include "timing.h"
+
+#include <algorithm>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Cycle-level timing layer over a Cache
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//////////////////////////////////////////////////////////////////////
+////////////////////     TIMING DEFINITIONS     //////////////////////
+//////////////////////////////////////////////////////////////////////
+
+MemoryChannel::MemoryChannel(uint wordsPerCycle)
+{
+    this->wordsPerCycle = (wordsPerCycle > 0) ? wordsPerCycle : 1;
+}
+
+unsigned long long MemoryChannel::transfer(unsigned long long earliest, uint blockSize)
+{
+    unsigned long long start = (earliest > busyUntil) ? earliest : busyUntil;
+    uint cycles = (blockSize + wordsPerCycle - 1) / wordsPerCycle;
+
+    busyUntil = start + cycles;
+    busyCycles += cycles;
+    return start;
+}
+
+TimingModel::TimingModel(const TimingConfig& config, MemoryChannel* channel, Cache* cR, uint blockSize)
+{
+    this->config = config;
+    this->channel = channel;
+    this->cacheRef = cR;
+    this->blockSize = blockSize;
+
+    if(this->config.mshrs == 0)  {
+        this->config.mshrs = 1;
+    }
+    if(this->config.ports == 0)  {
+        this->config.ports = 1;
+    }
+
+    if(this->config.bankBusy > 0)
+    {
+        bankFree.assign(cR->getNumBanks(), 0);
+        bankConflicts.assign(cR->getNumBanks(), 0);
+        setConflicts.assign(cR->getNumSets(), 0);
+        conflictsPerCycle.assign(this->config.ports + 1, 0);
+    }
+
+    mshrBlock = new addr_t[this->config.mshrs]();
+    mshrFill = new unsigned long long[this->config.mshrs]();
+    occupancy.assign(this->config.mshrs + 1, 0);
+}
+
+TimingModel::~TimingModel()
+{
+    delete[] mshrBlock;
+    delete[] mshrFill;
+}
+
+void TimingModel::advanceTo(unsigned long long t)
+{
+    //retire fills in completion order, crediting each occupancy level
+    while(active > 0)
+    {
+        int first = -1;
+        for(uint m = 0; m < config.mshrs; m++)  {
+            if(mshrFill[m] != 0 && (first < 0 || mshrFill[m] < mshrFill[first]))  {
+                first = m;
+            }
+        }
+        if(mshrFill[first] > t)  {
+            break;
+        }
+
+        if(mshrFill[first] > lastTime)  {
+            occupancy[active] += mshrFill[first] - lastTime;
+            lastTime = mshrFill[first];
+        }
+        mshrFill[first] = 0;
+        active--;
+    }
+
+    if(t > lastTime)  {
+        occupancy[active] += t - lastTime;
+        lastTime = t;
+    }
+}
+
+void TimingModel::countConflict(uint bank, uint set, unsigned long long cycle)
+{
+    conflicts++;
+    bankConflicts[bank]++;
+    setConflicts[set]++;
+
+    //close the previous cycle's count when a new cycle conflicts
+    if(conflictsInCycle > 0 && cycle != conflictCycle)  {
+        conflictsPerCycle[conflictsInCycle]++;
+        conflictsInCycle = 0;
+    }
+    conflictCycle = cycle;
+    if(conflictsInCycle < config.ports)  {
+        conflictsInCycle++;
+    }
+}
+
+int TimingModel::findMshr(addr_t block)
+{
+    for(uint m = 0; m < config.mshrs; m++)  {
+        if(mshrFill[m] != 0 && mshrBlock[m] == block)  {
+            return m;
+        }
+    }
+    return -1;
+}
+
+void TimingModel::advance(const Access* accesses, const unsigned char* status, uint count)
+{
+    for(uint i = 0; i < count; i++)
+    {
+        if(status[i] == C_SKIPPED)  {
+            continue;
+        }
+
+        unsigned long long issue = clock->next;
+
+        //bank still serving an earlier access: wait for it
+        if(config.bankBusy > 0)
+        {
+            uint bank = cacheRef->getBank(accesses[i].address);
+            if(bankFree[bank] > issue)
+            {
+                countConflict(bank, cacheRef->getIndex(accesses[i].address), issue);
+                issue = bankFree[bank];
+                clock->inGroup = 0;
+            }
+            bankFree[bank] = issue + config.bankBusy;
+        }
+
+        advanceTo(issue);
+
+        addr_t block = accesses[i].address / blockSize;
+        unsigned long long done;
+
+        int pending = findMshr(block);
+        if(pending >= 0)
+        {
+            //block is still on its way: wait for the fill
+            mergedMisses++;
+            done = mshrFill[pending];
+            if(done < issue + config.hitLatency)  {
+                done = issue + config.hitLatency;
+            }
+        }
+        else if(status[i] == C_HIT)
+        {
+            done = issue + config.hitLatency;
+        }
+        else
+        {
+            primaryMisses++;
+
+            //all MSHRs busy: hold issue until the earliest one frees up
+            if(active == config.mshrs)
+            {
+                unsigned long long earliest = mshrFill[0];
+                for(uint m = 1; m < config.mshrs; m++)  {
+                    if(mshrFill[m] < earliest)  {
+                        earliest = mshrFill[m];
+                    }
+                }
+                stallCycles += earliest - issue;
+                issue = earliest;
+                clock->inGroup = 0;
+                advanceTo(issue);
+            }
+
+            //request goes out after the tag check, once the channel is free
+            unsigned long long start = channel->transfer(issue + config.hitLatency, blockSize);
+            if(status[i] == C_MISS_DIR)  {
+                channel->transfer(start, blockSize);    //dirty victim goes back too
+            }
+            done = start + config.missLatency;
+
+            for(uint m = 0; m < config.mshrs; m++)  {
+                if(mshrFill[m] == 0)  {
+                    mshrBlock[m] = block;
+                    mshrFill[m] = done;
+                    active++;
+                    break;
+                }
+            }
+        }
+
+        timed++;
+        totalLatency += done - issue;
+        if(done > finish)  {
+            finish = done;
+        }
+        //up to <ports> accesses share an issue cycle
+        clock->next = issue;
+        clock->inGroup++;
+        if(clock->inGroup >= config.ports)  {
+            clock->next = issue + config.issueGap;
+            clock->inGroup = 0;
+        }
+    }
+}
+
+void advanceShared(TimingModel* data, const unsigned char* dataStatus,
+                   TimingModel* fetch, const unsigned char* fetchStatus, const Access* accesses, uint count)
+{
+    for(uint i = 0; i < count; i++)
+    {
+        data->advance(accesses + i, dataStatus + i, 1);
+        fetch->advance(accesses + i, fetchStatus + i, 1);
+    }
+}
+
+void TimingModel::drain()
+{
+    advanceTo(finish);
+    if(conflictsInCycle > 0)  {
+        conflictsPerCycle[conflictsInCycle]++;
+        conflictsInCycle = 0;
+    }
+}
+
+double TimingModel::getMlp()
+{
+    unsigned long long busy = 0, weighted = 0;
+    for(uint k = 1; k <= config.mshrs; k++)  {
+        busy += occupancy[k];
+        weighted += k * occupancy[k];
+    }
+    return (busy > 0) ? (double) weighted / busy : 0;
+}
+
+void TimingModel::report(std::ostream& out, const char* prefix)
+{
+    drain();
+    double amat = (timed > 0) ? (double) totalLatency / timed : 0;
+    double mlp = getMlp();
+
+    out << prefix << "cycles " << finish << std::endl;
+    out << prefix << "amat " << amat << std::endl;
+    out << prefix << "misses " << primaryMisses << " merged " << mergedMisses << std::endl;
+    out << prefix << "mshr stall cycles " << stallCycles << std::endl;
+    out << prefix << "mlp " << mlp << std::endl;
+    for(uint k = 0; k <= config.mshrs; k++)  {
+        out << prefix << "mshr occupancy " << k << " " << occupancy[k] << std::endl;
+    }
+
+    if(config.bankBusy == 0)  {
+        return;
+    }
+
+    out << prefix << "bank conflicts " << conflicts << " ("
+        << ((finish > 0) ? (double) conflicts / finish : 0) << " per cycle)" << std::endl;
+    for(uint k = 1; k <= config.ports; k++)  {
+        out << prefix << "cycles with " << k << " bank conflicts " << conflictsPerCycle[k] << std::endl;
+    }
+    for(size_t b = 0; b < bankConflicts.size(); b++)  {
+        out << prefix << "bank " << b << " conflicts " << bankConflicts[b] << std::endl;
+    }
+
+    //sets hit hardest, most conflicts first
+    std::vector<std::pair<unsigned long long, uint>> worst;
+    for(size_t set = 0; set < setConflicts.size(); set++)  {
+        if(setConflicts[set] > 0)  {
+            worst.push_back(std::make_pair(setConflicts[set], (uint) set));
+        }
+    }
+    size_t shown = (worst.size() < C_TOP_SETS) ? worst.size() : C_TOP_SETS;
+    std::partial_sort(worst.begin(), worst.begin() + shown, worst.end(),
+                      std::greater<std::pair<unsigned long long, uint>>());
+    for(size_t k = 0; k < shown; k++)  {
+        out << prefix << "set " << worst[k].second << " conflicts " << worst[k].first << std::endl;
+    }
+}
+
+void TimingModel::exportStats(StatGroup& group)
+{
+    drain();
+
+    addStat(group, "cycles", (long long) finish, "cycles", "cycle the last access completed");
+    addStat(group, "amat", (timed > 0) ? (double) totalLatency / timed : 0.0, "cycles",
+            "average memory access time");
+    addStat(group, "misses", (long long) primaryMisses, "misses", "misses that allocated an MSHR");
+    addStat(group, "merged_misses", (long long) mergedMisses, "accesses",
+            "accesses to a block still being filled");
+    addStat(group, "mshr_stall_cycles", (long long) stallCycles, "cycles", "issue held back by full MSHRs");
+    addStat(group, "mlp", getMlp(), "mshrs", "average MSHRs busy while any were");
+    for(uint k = 0; k <= config.mshrs; k++)  {
+        addStat(group, "mshr_occupancy_" + std::to_string(k), (long long) occupancy[k], "cycles",
+                "cycles with this many MSHRs busy");
+    }
+
+    if(config.bankBusy == 0)  {
+        return;
+    }
+
+    addStat(group, "bank_conflicts", (long long) conflicts, "accesses", "accesses delayed by a busy bank");
+    for(uint k = 1; k <= config.ports; k++)  {
+        addStat(group, "cycles_with_" + std::to_string(k) + "_conflicts", (long long) conflictsPerCycle[k],
+                "cycles", "issue cycles with this many bank conflicts");
+    }
+    for(size_t b = 0; b < bankConflicts.size(); b++)  {
+        addStat(group, "bank_" + std::to_string(b) + "_conflicts", (long long) bankConflicts[b], "accesses",
+                "conflicts on this bank");
+    }
+}
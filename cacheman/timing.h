@@ -0,0 +1,118 @@
+#ifndef CACHEMAN_TIMING_H
+#define CACHEMAN_TIMING_H
+
+#include "cache.h"
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Cycle-level timing layer: MSHRs, banks and the memory channel
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : MemoryChannel, TimingModel
+*    Application        : Optional timing layer over a Cache: issues one access every <issueGap>
+*                         cycles, charges hit/miss latencies, merges misses to the same block in
+*                         MSHRs (stalling issue when all are busy) and limits memory bandwidth;
+*                         with banks, an access waits for its bank to finish the previous one
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//memory bus shared by all caches; block transfers and writebacks occupy it in turn
+class MemoryChannel
+{
+private:
+    uint wordsPerCycle;
+public:
+    unsigned long long busyUntil = 0;   //first cycle the channel is free
+    unsigned long long busyCycles = 0;
+
+    MemoryChannel(uint wordsPerCycle);
+
+    //reserves the channel for one block from <earliest> on, returns the start cycle
+    unsigned long long transfer(unsigned long long earliest, uint blockSize);
+};
+
+//issue point of the front end; the I- and D-side models share one, so they run on one clock
+typedef struct IssueClockst
+{
+    unsigned long long next = 0;    //cycle the next access may issue
+    uint inGroup = 0;               //accesses already issued at <next>
+}  IssueClock;
+
+typedef struct TimingConfigst
+{
+    uint hitLatency  = 1;
+    uint missLatency = 100;     //memory latency on top of the hit
+    uint mshrs       = 8;
+    uint issueGap    = 1;       //cycles between issue groups
+    uint ports       = 1;       //accesses issued together per group
+    uint bankBusy    = 0;       //cycles an access holds its bank, 0 ignores banks
+}  TimingConfig;
+
+class TimingModel
+{
+private:
+    TimingConfig config;
+    MemoryChannel* channel;
+    Cache* cacheRef;        //for bank and set of each access
+    uint blockSize;
+
+    IssueClock ownClock;
+    IssueClock* clock = &ownClock;      //ownClock, or another model's when shared
+    unsigned long long lastTime = 0;    //occupancy accounted up to this cycle
+    unsigned long long finish = 0;      //latest completion so far
+
+    //outstanding misses: block address and fill cycle, fill 0 when free
+    addr_t* mshrBlock;
+    unsigned long long* mshrFill;
+    uint active = 0;
+
+    //stats
+    unsigned long long timed = 0;           //accesses timed
+    unsigned long long totalLatency = 0;
+    unsigned long long primaryMisses = 0;
+    unsigned long long mergedMisses = 0;    //hits and misses on a block still being filled
+    unsigned long long stallCycles = 0;     //issue held back by full MSHRs
+    std::vector<unsigned long long> occupancy;  //cycles spent with k MSHRs busy
+
+    //banks: cycle each bank frees up, and conflicts by bank, set and cycle
+    std::vector<unsigned long long> bankFree;
+    std::vector<unsigned long long> bankConflicts;
+    std::vector<unsigned long long> setConflicts;
+    unsigned long long conflicts = 0;
+    unsigned long long conflictCycle = 0;       //issue cycle of the last conflict
+    uint conflictsInCycle = 0;
+    std::vector<unsigned long long> conflictsPerCycle;    //cycles with k conflicts, k >= 1
+
+    void countConflict(uint bank, uint set, unsigned long long cycle);
+
+    //accounts MSHR occupancy up to cycle <t>, retiring fills that complete by then
+    void advanceTo(unsigned long long t);
+    int findMshr(addr_t block);
+    //retires the outstanding misses and closes the last cycle's conflict count, before reporting
+    void drain();
+    //average MSHRs busy over the cycles any were
+    double getMlp();
+public:
+    TimingModel(const TimingConfig& config, MemoryChannel* channel, Cache* cR, uint blockSize);
+    ~TimingModel();
+
+    //issues from <other>'s clock from now on
+    void shareClock(TimingModel* other)  {clock = other->clock;}
+
+    //times the accesses, given the C_HIT/C_MISS_* status Cache::access() reported for each
+    void advance(const Access* accesses, const unsigned char* status, uint count);
+
+    //AMAT, stalls, miss-level parallelism and the MSHR occupancy histogram,
+    //then bank conflicts when banks are modelled
+    void report(std::ostream& out, const char* prefix);
+    //the same counters as named values, without the per-set list
+    void exportStats(StatGroup& group);
+};
+
+//times a batch on a D-side and an I-side model sharing a clock, access by access in trace order,
+//so their misses reach the MemoryChannel in time order; C_SKIPPED marks the other side's accesses
+void advanceShared(TimingModel* data, const unsigned char* dataStatus,
+                   TimingModel* fetch, const unsigned char* fetchStatus, const Access* accesses, uint count);
+
+#endif
@@ -0,0 +1,825 @@
+#include "trace.h"
+#include "stats.h"
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Trace sources and parsers, the reader thread and the trace generator
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+//////////////////////////////////////////////////////////////////////
+////////////////////      TRACE DEFINITIONS      /////////////////////
+//////////////////////////////////////////////////////////////////////
+
+TraceSource::~TraceSource()
+{
+    if(mapped != NULL)  {
+        munmap(mapped, mappedSize);
+    }
+    delete[] chunk;
+    if(fd >= 0)  {
+        close(fd);
+    }
+    if(child > 0)  {
+        waitpid(child, NULL, 0);
+    }
+}
+
+int TraceSource::spawnDecompressor(const char* tool, const std::string& filename)
+{
+    int pipefd[2];
+    if(pipe(pipefd) != 0)  {
+        return -1;
+    }
+
+    child = fork();
+    if(child < 0)  {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return -1;
+    }
+    if(child == 0)
+    {
+        //child: decompress the file onto the pipe
+        dup2(pipefd[1], STDOUT_FILENO);
+        close(pipefd[0]);
+        close(pipefd[1]);
+        execlp(tool, tool, "-dc", filename.c_str(), (char*) NULL);
+        _exit(127);
+    }
+
+    close(pipefd[1]);
+    return pipefd[0];
+}
+
+bool TraceSource::open(const std::string& filename)
+{
+    //compressed traces go through the matching command-line tool
+    const char* tool = NULL;
+    size_t dot = filename.rfind('.');
+    if(dot != std::string::npos)
+    {
+        std::string ext = filename.substr(dot);
+        if(ext == ".gz")        {tool = "gzip";}
+        else if(ext == ".xz")   {tool = "xz";}
+        else if(ext == ".bz2")  {tool = "bzip2";}
+        else if(ext == ".zst")  {tool = "zstd";}
+    }
+
+    if(filename == "-")  {
+        fd = dup(STDIN_FILENO);
+    }
+    else if(tool != NULL)  {
+        this->tool = tool;
+        fd = spawnDecompressor(tool, filename);
+    }
+    else  {
+        fd = ::open(filename.c_str(), O_RDONLY);
+    }
+    if(fd < 0)  {
+        std::cerr << "cannot open trace " << filename << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if(tool == NULL && fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        //regular file: map it and parse in place
+        mappedSize = info.st_size;
+        if(mappedSize == 0)  {
+            eof = true;
+            return true;
+        }
+
+        void* m = mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m != MAP_FAILED)
+        {
+            madvise(m, mappedSize, MADV_SEQUENTIAL);
+            mapped = (char*) m;
+            cursor = mapped;
+            limit  = mapped + mappedSize;
+            eof    = true;
+            return true;
+        }
+        mappedSize = 0;
+    }
+
+    //anything else is read in chunks
+    chunkCapacity = C_TRAC_CHUNK;
+    chunk  = new char[chunkCapacity];
+    cursor = chunk;
+    limit  = chunk;
+    return true;
+}
+
+bool TraceSource::refill()
+{
+    if(eof)  {
+        return false;
+    }
+
+    //move the unconsumed tail (a partial record) to the front
+    size_t left = limit - cursor;
+    memmove(chunk, cursor, left);
+    cursor = chunk;
+    limit  = chunk + left;
+
+    //a read into no room returns 0 too, which is not the end of the trace
+    if(left == chunkCapacity)
+    {
+        std::cerr << "a trace record is longer than " << chunkCapacity << " bytes" << std::endl;
+        eof = true;
+        failed = true;
+        return false;
+    }
+
+    ssize_t got;
+    do  {
+        got = read(fd, chunk + left, chunkCapacity - left);
+    }  while(got < 0 && errno == EINTR);
+
+    if(got <= 0)
+    {
+        eof = true;
+        if(got < 0)
+        {
+            std::cerr << "reading the trace failed: " << strerror(errno) << std::endl;
+            failed = true;
+        }
+
+        //a decompressor that could not run or choked on its input still closes the pipe cleanly
+        int status;
+        if(child > 0 && waitpid(child, &status, 0) == child)
+        {
+            child = -1;
+            if(WIFEXITED(status) && WEXITSTATUS(status) == 127)  {
+                std::cerr << "cannot run " << tool << " to decompress the trace" << std::endl;
+                failed = true;
+            }
+            else if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)  {
+                std::cerr << tool << " failed to decompress the trace" << std::endl;
+                failed = true;
+            }
+        }
+        return false;
+    }
+
+    limit += got;
+    return true;
+}
+
+//parses hex digits (optionally 0x-prefixed) at p; returns false if none
+static inline bool parseHex(const char*& p, const char* end, addr_t& value)
+{
+    if(end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))  {
+        p += 2;
+    }
+
+    const char* start = p;
+    addr_t v = 0;
+    while(p < end)
+    {
+        char c = *p;
+        uint digit;
+        if(c >= '0' && c <= '9')       {digit = c - '0';}
+        else if(c >= 'a' && c <= 'f')  {digit = c - 'a' + 10;}
+        else if(c >= 'A' && c <= 'F')  {digit = c - 'A' + 10;}
+        else  {break;}
+
+        v = (v << 4) | digit;
+        p++;
+    }
+
+    value = v;
+    return p != start;
+}
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+//parses a decimal number at p; returns false if none
+static inline bool parseDec(const char*& p, const char* end, uint& value)
+{
+    const char* start = p;
+    uint v = 0;
+    while(p < end && *p >= '0' && *p <= '9')  {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+
+    value = v;
+    return p != start;
+}
+
+static inline void skipSpaces(const char*& p, const char* end)
+{
+    while(p < end && (*p == ' ' || *p == '\t'))  {
+        p++;
+    }
+}
+
+//moves p to the newline ending the current line; false if the line is not complete yet
+static inline bool skipLine(const char*& p, const char* end, bool final)
+{
+    const char* nl = (const char*) memchr(p, '\n', end - p);
+    p = (nl != NULL) ? nl : end;
+    return nl != NULL || final;
+}
+
+static inline uint loadLE32(const unsigned char* r)
+{
+    return r[0] | (r[1] << 8) | (r[2] << 16) | ((uint) r[3] << 24);
+}
+
+static inline addr_t loadLE64(const unsigned char* r)
+{
+    addr_t v = 0;
+    for(int i = 7; i >= 0; i--)  {
+        v = (v << 8) | r[i];
+    }
+    return v;
+}
+
+uint TraceParser::emit(Access* out, uint room, addr_t address, uint size, bool write, bool fetch)
+{
+    if(room == 0)  {
+        return 0;
+    }
+
+    out->address = address;
+    out->size = (size > 0) ? size : 1;
+    out->write = write;
+    out->fetch = fetch;
+    out->pc = pc;
+    return 1;
+}
+
+uint TraceParser::emitBytes(Access* out, uint room, addr_t address, uint size, bool write, bool fetch)
+{
+    //the words holding bytes [address, address + size)
+    addr_t first = address >> C_TRAC_WORD_SHIFT;
+    addr_t last = (address + ((size > 0) ? size : 1) - 1) >> C_TRAC_WORD_SHIFT;
+    return emit(out, room, first, (uint) (last - first + 1), write, fetch);
+}
+
+uint TextTraceParser::parse(const char*& p, const char* end, Access* out, uint max, bool final)
+{
+    uint n = 0;
+
+    while(n < max)
+    {
+        while(p < end && isBlank(*p))  {
+            p++;
+        }
+        if(p == end)  {
+            break;
+        }
+
+        const char* record = p;
+
+        //address token
+        addr_t address;
+        bool valid = parseHex(p, end, address);
+        if(p == end && !final)  {
+            p = record;     //token may continue in the next chunk
+            break;
+        }
+
+        //command character
+        skipSpaces(p, end);
+        char command = (p < end) ? *p : 0;
+
+        //optional pc
+        pc = 0;
+        if(p < end)  {
+            p++;
+            skipSpaces(p, end);
+            if(p < end && *p != '\n' && *p != '\r' && !parseHex(p, end, pc))  {
+                pc = 0;
+            }
+        }
+
+        //rest of the line
+        if(!skipLine(p, end, final))  {
+            p = record;
+            break;
+        }
+
+        if(valid && (command == 'r' || command == 'w'))  {
+            n += emit(out + n, max - n, address, 1, command == 'w', false);
+        }
+    }
+
+    return n;
+}
+
+uint BinaryTraceParser::parse(const char*& p, const char* end, Access* out, uint max, bool final)
+{
+    if(failed)
+    {
+        p = end;
+        return 0;
+    }
+    if(!headerSeen)
+    {
+        if(end - p < C_TRAC_BIN_HEADER)  {
+            if(final)
+            {
+                std::cerr << "binary trace is missing its header" << std::endl;
+                failed = true;
+                p = end;
+            }
+            return 0;
+        }
+
+        uint version = loadLE32((const unsigned char*) p + 4);
+        if(memcmp(p, C_TRAC_BIN_MAGIC, 4) != 0)  {
+            std::cerr << "not a binary trace: no " << C_TRAC_BIN_MAGIC << " header" << std::endl;
+            failed = true;
+        }
+        else if(version != C_TRAC_BIN_VERSION)  {
+            std::cerr << "unsupported binary trace version " << version << std::endl;
+            failed = true;
+        }
+        if(failed)
+        {
+            p = end;
+            return 0;
+        }
+        p += C_TRAC_BIN_HEADER;
+        headerSeen = true;
+    }
+
+    uint n = 0;
+    while(n < max && end - p >= C_TRAC_BIN_RECORD)
+    {
+        const unsigned char* r = (const unsigned char*) p;
+        n += emit(out + n, max - n, loadLE64(r), 1, r[8] & 1, false);
+        p += C_TRAC_BIN_RECORD;
+    }
+
+    //a truncated last record is dropped
+    if(final && n < max && end - p < C_TRAC_BIN_RECORD)  {
+        p = end;
+    }
+
+    return n;
+}
+
+uint LackeyTraceParser::parse(const char*& p, const char* end, Access* out, uint max, bool final)
+{
+    uint n = 0;
+
+    while(n < max)
+    {
+        while(p < end && isBlank(*p))  {
+            p++;
+        }
+        if(p == end)  {
+            break;
+        }
+
+        const char* record = p;
+
+        char kind = *p++;
+        skipSpaces(p, end);
+
+        addr_t address = 0;
+        uint size = 0;
+        bool valid = parseHex(p, end, address);
+        if(p < end && *p == ',')  {
+            p++;
+            valid = parseDec(p, end, size) && valid;
+        }
+        else  {
+            valid = false;
+        }
+
+        if(!skipLine(p, end, final))  {
+            p = record;
+            break;
+        }
+        if(!valid)  {
+            continue;   //valgrind banner or other noise
+        }
+
+        uint got;
+        if(kind == 'I')  {
+            instructions++;
+            pc = address;   //data accesses that follow are this instruction's
+            if(!keepFetches)  {
+                continue;
+            }
+            got = emitBytes(out + n, max - n, address, size, false, true);
+        }
+        else if(kind == 'L' || kind == 'S')  {
+            got = emitBytes(out + n, max - n, address, size, kind == 'S', false);
+        }
+        else if(kind == 'M')
+        {
+            //read-modify-write: both halves or neither
+            got = emitBytes(out + n, max - n, address, size, false, false);
+            if(got > 0)
+            {
+                uint second = emitBytes(out + n + got, max - n - got, address, size, true, false);
+                got = (second > 0) ? got + second : 0;
+            }
+        }
+        else  {
+            continue;
+        }
+
+        if(got == 0)  {
+            p = record;     //no room left in this batch
+            break;
+        }
+        n += got;
+    }
+
+    return n;
+}
+
+uint DinTraceParser::parse(const char*& p, const char* end, Access* out, uint max, bool final)
+{
+    uint n = 0;
+
+    while(n < max)
+    {
+        while(p < end && isBlank(*p))  {
+            p++;
+        }
+        if(p == end)  {
+            break;
+        }
+
+        const char* record = p;
+
+        uint label = 0;
+        addr_t address = 0, size = 1;
+        bool valid = parseDec(p, end, label);
+        skipSpaces(p, end);
+        valid = parseHex(p, end, address) && valid;
+        skipSpaces(p, end);
+        if(p < end && *p != '\n' && *p != '\r')  {
+            parseHex(p, end, size);
+        }
+
+        if(!skipLine(p, end, final))  {
+            p = record;
+            break;
+        }
+        if(valid && label == 2)  {
+            instructions++;
+            pc = address;
+        }
+        if(!valid || label > 2 || (label == 2 && !keepFetches))  {
+            continue;
+        }
+
+        uint got = emitBytes(out + n, max - n, address, size, label == 1, label == 2);
+        if(got == 0)  {
+            p = record;
+            break;
+        }
+        n += got;
+    }
+
+    return n;
+}
+
+uint ChampSimTraceParser::parse(const char*& p, const char* end, Access* out, uint max, bool final)
+{
+    uint n = 0;
+
+    //one record can yield a fetch, 4 loads and 2 stores
+    while(max - n >= 7 && end - p >= C_TRAC_CHAMPSIM_RECORD)
+    {
+        const unsigned char* r = (const unsigned char*) p;
+
+        //layout: ip(8) is_branch(1) branch_taken(1) dst_regs(2) src_regs(4)
+        //        destination_memory(2 x 8) source_memory(4 x 8)
+        instructions++;
+        pc = loadLE64(r);
+        if(keepFetches)  {
+            n += emitBytes(out + n, max - n, loadLE64(r), 1, false, true);
+        }
+        for(int i = 0; i < 4; i++)  {
+            addr_t address = loadLE64(r + 32 + 8 * i);
+            if(address != 0)  {
+                n += emitBytes(out + n, max - n, address, 1, false, false);
+            }
+        }
+        for(int i = 0; i < 2; i++)  {
+            addr_t address = loadLE64(r + 16 + 8 * i);
+            if(address != 0)  {
+                n += emitBytes(out + n, max - n, address, 1, true, false);
+            }
+        }
+
+        p += C_TRAC_CHAMPSIM_RECORD;
+    }
+
+    //a truncated last record is dropped
+    if(final && max - n >= 7 && end - p < C_TRAC_CHAMPSIM_RECORD)  {
+        p = end;
+    }
+
+    return n;
+}
+
+TraceReader::~TraceReader()
+{
+    //an early return leaves the reader waiting on batches that never come back
+    stopping.store(true);
+    freeBatches.wake();
+    if(worker.joinable())  {
+        worker.join();
+    }
+    for(int i = 0; i < C_BATCH_POOL; i++)  {
+        delete[] pool[i].accesses;
+    }
+    delete parser;
+}
+
+bool TraceReader::open(const std::string& filename, int format, bool keepFetches)
+{
+    if(!source.open(filename))  {
+        return false;
+    }
+
+    if(format == C_TRAC_AUTO)
+    {
+        //peek at the start for the binary magic
+        if(source.end() - source.begin() < C_TRAC_BIN_HEADER)  {
+            source.refill();
+        }
+        bool magic = (source.end() - source.begin() >= 4) &&
+                     memcmp(source.begin(), C_TRAC_BIN_MAGIC, 4) == 0;
+        format = magic ? C_TRAC_BIN : C_TRAC_TEXT;
+    }
+
+    if(format == C_TRAC_BIN)            {parser = new BinaryTraceParser();}
+    else if(format == C_TRAC_LACKEY)    {parser = new LackeyTraceParser();}
+    else if(format == C_TRAC_DIN)       {parser = new DinTraceParser();}
+    else if(format == C_TRAC_CHAMPSIM)  {parser = new ChampSimTraceParser();}
+    else                                {parser = new TextTraceParser();}
+
+    parser->configure(keepFetches);
+
+    for(int i = 0; i < C_BATCH_POOL; i++)
+    {
+        pool[i].accesses = new Access[C_BATCH_SIZE];
+        freeBatches.push(&pool[i]);
+    }
+
+    worker = std::thread(&TraceReader::run, this);
+    return true;
+}
+
+bool TraceReader::fill(Batch* batch)
+{
+    batch->count = 0;
+
+    while(true)
+    {
+        const char* p = source.begin();
+        batch->count += parser->parse(p, source.end(), batch->accesses + batch->count,
+                                      C_BATCH_SIZE - batch->count, source.atEof());
+        source.advance(p);
+
+        //parsers only stop short for room when less than a whole record fits
+        if(C_BATCH_SIZE - batch->count < C_TRAC_RECORD_MAX)  {
+            return true;
+        }
+        if(source.atEof() || parser->hasFailed())  {
+            return false;
+        }
+        source.refill();
+    }
+}
+
+void TraceReader::run()
+{
+    if(onStart)  {
+        onStart();
+    }
+
+    bool more = true;
+    while(more)
+    {
+        Batch* batch;
+        if(!freeBatches.popWait(batch, &stopping))  {
+            return;
+        }
+
+        more = fill(batch);
+
+        if(batch->count > 0)  {
+            fullBatches.pushWait(batch);
+        }
+        else  {
+            freeBatches.push(batch);
+        }
+    }
+
+    //before the end marker, which publishes what it leaves
+    if(onEnd)  {
+        onEnd();
+    }
+
+    //end of trace marker
+    fullBatches.pushWait(NULL);
+}
+
+Batch* TraceReader::acquire()
+{
+    Batch* batch;
+    fullBatches.popWait(batch);
+    return batch;
+}
+
+void TraceReader::release(Batch* batch)
+{
+    freeBatches.push(batch);
+}
+
+//////////////////////////////////////////////////////////////////////
+///////////////////     GENERATOR DEFINITIONS     ////////////////////
+//////////////////////////////////////////////////////////////////////
+
+//natural log and exp from + - * / alone, so the zipf weights are the same bits everywhere
+//(build without FMA contraction, see build.sh)
+static double exactLog(double x)
+{
+    //x = m * 2^e with m in [1, 2), then ln m = 2 atanh((m-1)/(m+1))
+    int e = 0;
+    while(x >= 2)  {x /= 2; e++;}
+    while(x < 1)   {x *= 2; e--;}
+
+    double t = (x - 1) / (x + 1);
+    double t2 = t * t;
+    double term = t, sum = 0;
+    for(int k = 1; k < 50; k += 2)  {
+        sum += term / k;
+        term *= t2;
+    }
+    return 2 * sum + e * 0.6931471805599453;
+}
+
+static double exactExp(double y)
+{
+    //y = n ln2 + r, e^r by its series
+    long long n = (long long) (y / 0.6931471805599453);
+    double r = y - n * 0.6931471805599453;
+
+    double term = 1, sum = 1;
+    for(int k = 1; k < 30; k++)  {
+        term *= r / k;
+        sum += term;
+    }
+    for(; n > 0; n--)  {sum *= 2;}
+    for(; n < 0; n++)  {sum /= 2;}
+    return sum;
+}
+
+TraceGenerator::TraceGenerator(const GeneratorConfig& config)
+{
+    this->config = config;
+    if(this->config.stride == 0)  {
+        this->config.stride = 1;
+    }
+    if(this->config.footprint < this->config.stride)  {
+        this->config.footprint = this->config.stride;
+    }
+    slots = this->config.footprint / this->config.stride;
+
+    state = seedRandom(config.seed);
+
+    bool mixed = (config.pattern == C_GEN_MIXED);
+    if(config.pattern == C_GEN_ZIPF || mixed)
+    {
+        cdf.resize(slots);
+        double sum = 0;
+        for(addr_t k = 0; k < slots; k++)  {
+            sum += exactExp(-this->config.skew * exactLog((double) (k + 1)));
+            cdf[k] = sum;
+        }
+        for(addr_t k = 0; k < slots; k++)  {
+            cdf[k] /= sum;
+        }
+    }
+    if(config.pattern == C_GEN_CHASE || mixed)
+    {
+        //Sattolo's shuffle: one cycle through every node
+        next.resize(slots);
+        for(addr_t k = 0; k < slots; k++)  {
+            next[k] = k;
+        }
+        for(addr_t k = slots - 1; k > 0; k--)  {
+            addr_t j = random() % k;
+            std::swap(next[k], next[j]);
+        }
+    }
+
+    buffer.resize(C_BATCH_SIZE);
+    batch.accesses = buffer.data();
+}
+
+unsigned long long TraceGenerator::random()
+{
+    return nextRandom(state);
+}
+
+addr_t TraceGenerator::nextAddress(int pattern)
+{
+    addr_t offset;
+    if(pattern == C_GEN_SEQUENTIAL)
+    {
+        offset = position % config.footprint;
+        position++;
+    }
+    else if(pattern == C_GEN_STRIDED)
+    {
+        offset = (position * config.stride) % config.footprint;
+        position++;
+    }
+    else if(pattern == C_GEN_RANDOM)
+    {
+        offset = random() % config.footprint;
+    }
+    else if(pattern == C_GEN_ZIPF)
+    {
+        //popular items are scattered over the footprint, not packed at its start
+        double u = (random() >> 11) * (1.0 / (1ULL << 53));
+        addr_t item = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        if(item >= slots)  {
+            item = slots - 1;
+        }
+        offset = ((item * 40503) % slots) * config.stride;
+    }
+    else
+    {
+        node = next[node];
+        offset = (addr_t) node * config.stride;
+    }
+
+    return config.base + offset;
+}
+
+uint TraceGenerator::generate(Access* out, uint max)
+{
+    uint n = 0;
+    while(n < max && produced < config.length)
+    {
+        int pattern = config.pattern;
+        if(pattern == C_GEN_MIXED)  {
+            pattern = random() % C_GEN_MIXED;
+        }
+
+        out[n] = Access();
+        out[n].address = nextAddress(pattern);
+        out[n].write = (random() % 100) < config.writes;
+        n++;
+        produced++;
+    }
+    return n;
+}
+
+Batch* TraceGenerator::acquire()
+{
+    batch.count = generate(batch.accesses, C_BATCH_SIZE);
+    return (batch.count > 0) ? &batch : NULL;
+}
+
+bool TraceGenerator::writeBinary(const std::string& path)
+{
+    BufferedWriter out;
+    if(!out.open(path))  {
+        return false;
+    }
+
+    out.put(C_TRAC_BIN_MAGIC, 4);
+    out.putLE32(C_TRAC_BIN_VERSION);
+
+    uint count;
+    while((count = generate(buffer.data(), C_BATCH_SIZE)) > 0)  {
+        for(uint i = 0; i < count; i++)  {
+            out.putLE64(buffer[i].address);
+            char flags = buffer[i].write ? 1 : 0;
+            out.put(&flags, 1);
+        }
+    }
+    return out.flush();
+}
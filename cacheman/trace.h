@@ -0,0 +1,444 @@
+#ifndef CACHEMAN_TRACE_H
+#define CACHEMAN_TRACE_H
+
+#include "cache.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*-------------------------------------------------------------------------------------------------
+*    Author   : Team DOOFENSMARTZ
+*    Code     : Trace sources, parsers for each trace format, the reader thread and the generator
+*    Question : CS2610 A6
+-------------------------------------------------------------------------------------------------*/
+
+// Trace formats
+#define C_TRAC_AUTO 0
+#define C_TRAC_TEXT 1
+#define C_TRAC_BIN  2
+#define C_TRAC_LACKEY   3   //valgrind --tool=lackey --trace-mem=yes
+#define C_TRAC_DIN      4   //dinero "label address [size]"
+#define C_TRAC_CHAMPSIM 5   //ChampSim input_instr records
+
+//text and binary traces give 32-bit word addresses, like Cache, Memory and the Mmu; lackey, din
+//and champsim give byte addresses, turned into words as they are decoded
+#define C_TRAC_WORD_SHIFT 2
+
+#define C_TRAC_BIN_MAGIC  "CMTR"    //binary trace: magic, then 32-bit version
+#define C_TRAC_BIN_VERSION 1
+#define C_TRAC_BIN_HEADER 8
+#define C_TRAC_BIN_RECORD 9
+#define C_TRAC_CHUNK (1 << 20)      //read size for pipes and compressed traces
+#define C_TRAC_CHAMPSIM_RECORD 64   //ip, branch info, 6 register ids, 2 store and 4 load addresses
+#define C_TRAC_RECORD_MAX 8         //most accesses one record decodes into
+#define C_SPSC_SPIN 64              //yields an SpscQueue wait spins before it sleeps
+
+// Synthetic trace patterns (see TraceGenerator)
+#define C_GEN_SEQUENTIAL 0
+#define C_GEN_STRIDED    1
+#define C_GEN_RANDOM     2
+#define C_GEN_ZIPF       3
+#define C_GEN_CHASE      4  //pointer chasing around one random cycle
+#define C_GEN_MIXED      5  //each access from one of the above, picked at random
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : SpscQueue
+*    Application        : Lock-free single-producer single-consumer ring of <N> slots
+*                         (N a power of 2); push/pop fail instead of blocking, pushWait/popWait
+*                         spin C_SPSC_SPIN times and then sleep until the other side moves
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+template <typename T, uint N>
+class SpscQueue
+{
+private:
+    T slots[N];
+    std::atomic<uint> head{0};  //next slot to pop, owned by the consumer
+    std::atomic<uint> tail{0};  //next slot to push, owned by the producer
+
+    //a side that ran out of spins sleeps on <moved> until the other side pushes or pops
+    std::mutex lock;
+    std::condition_variable moved;
+    std::atomic<int> sleepers{0};
+
+    bool tryPush(T item);
+    bool tryPop(T& item);
+    //wakes a sleeping side, if any; called after every push and pop
+    void notify();
+public:
+    bool push(T item);
+    bool pop(T& item);
+
+    void pushWait(T item);
+    //false, with nothing popped, once <stop> is set (see wake())
+    bool popWait(T& item, const std::atomic<bool>* stop = NULL);
+    //wakes a sleeper to look at its stop flag
+    void wake();
+};
+
+template <typename T, uint N>
+bool SpscQueue<T, N>::tryPush(T item)
+{
+    uint t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) == N)  {
+        return false;   //full
+    }
+
+    slots[t & (N - 1)] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint N>
+bool SpscQueue<T, N>::tryPop(T& item)
+{
+    uint h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire))  {
+        return false;   //empty
+    }
+
+    item = slots[h & (N - 1)];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint N>
+void SpscQueue<T, N>::notify()
+{
+    //pairs with the fence in pushWait/popWait: either the sleeper sees the move, or we see it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        moved.notify_all();
+    }
+}
+
+template <typename T, uint N>
+bool SpscQueue<T, N>::push(T item)
+{
+    if(!tryPush(item))  {
+        return false;
+    }
+    notify();
+    return true;
+}
+
+template <typename T, uint N>
+bool SpscQueue<T, N>::pop(T& item)
+{
+    if(!tryPop(item))  {
+        return false;
+    }
+    notify();
+    return true;
+}
+
+template <typename T, uint N>
+void SpscQueue<T, N>::pushWait(T item)
+{
+    for(int i = 0; i < C_SPSC_SPIN; i++)
+    {
+        if(push(item))  {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        moved.wait(guard, [&]()  {return tryPush(item);});
+        sleepers.fetch_sub(1);
+    }
+    notify();
+}
+
+template <typename T, uint N>
+bool SpscQueue<T, N>::popWait(T& item, const std::atomic<bool>* stop)
+{
+    for(int i = 0; i < C_SPSC_SPIN; i++)
+    {
+        if(pop(item))  {
+            return true;
+        }
+        if(stop != NULL && stop->load())  {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    bool got = false;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        moved.wait(guard, [&]()  {
+            got = tryPop(item);
+            return got || (stop != NULL && stop->load());
+        });
+        sleepers.fetch_sub(1);
+    }
+    if(got)  {
+        notify();
+    }
+    return got;
+}
+
+template <typename T, uint N>
+void SpscQueue<T, N>::wake()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    moved.notify_all();
+}
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : TraceSource
+*    Application        : Byte window over a trace: regular files are mmapped whole, compressed
+*                         files are decompressed by a child process and read in chunks
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+class TraceSource
+{
+private:
+    int    fd = -1;
+    pid_t  child = -1;          //decompressor, if any
+    std::string tool;           //its name, for messages
+    bool   failed = false;      //read error, or the decompressor did not exit cleanly
+
+    char*  mapped = NULL;       //whole file, in mmap mode
+    size_t mappedSize = 0;
+
+    char*  chunk = NULL;        //chunk buffer, in read mode
+    size_t chunkCapacity = 0;
+
+    const char* cursor = NULL;  //first unconsumed byte
+    const char* limit = NULL;   //one past the last available byte
+    bool   eof = false;         //no bytes beyond <limit> will ever arrive
+
+    //bytes consumed so far, for progress reports from another thread
+    std::atomic<unsigned long long> consumed{0};
+
+    //starts <tool> -dc <filename> and returns the read end of its stdout
+    int spawnDecompressor(const char* tool, const std::string& filename);
+public:
+    ~TraceSource();
+
+    //opens the trace, returns false (with a message on stderr) on failure
+    //"-" streams from stdin; pipes and FIFOs are read in chunks with bounded memory
+    bool open(const std::string& filename);
+
+    const char* begin()  {return cursor;}
+    const char* end()    {return limit;}
+    bool atEof()         {return eof;}
+
+    //marks bytes up to <to> as consumed
+    void advance(const char* to)
+    {
+        consumed.store(consumed.load(std::memory_order_relaxed) + (to - cursor), std::memory_order_relaxed);
+        cursor = to;
+    }
+    //keeps the unconsumed tail and reads more behind it; false at end of input
+    bool refill();
+    //the input ended in error rather than at its real end, valid once atEof()
+    bool hasFailed()  {return failed;}
+
+    const std::atomic<unsigned long long>* getPosition()  {return &consumed;}
+    //bytes in the trace, 0 when it is streamed and the size is not known up front
+    unsigned long long getSize()  {return mappedSize;}
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Classes            : TraceParser (and specific formats)
+*    Application        : Decode trace records straight out of a TraceSource window
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+//base interface/abstract class
+class TraceParser
+{
+protected:
+    bool keepFetches = false;   //instruction fetches are dropped without an I-cache
+
+    unsigned long long instructions = 0;    //fetch records seen, kept or not
+    addr_t pc = 0;      //instruction the accesses emitted next belong to, 0 if unknown
+    bool failed = false;    //input is not in this format, nothing more is decoded
+
+    //appends the access to out[] whole, the cache splits it at its own blocks
+    //returns 1, or 0 if <room> is 0
+    uint emit(Access* out, uint room, addr_t address, uint size, bool write, bool fetch);
+    //the same for <size> bytes from a byte address, as the words they span
+    uint emitBytes(Access* out, uint room, addr_t address, uint size, bool write, bool fetch);
+public:
+    virtual ~TraceParser() {}
+
+    void configure(bool keepFetches)  {this->keepFetches = keepFetches;}
+    unsigned long long getInstructions()  {return instructions;}
+    bool hasFailed()  {return failed;}
+
+    //decodes up to <max> records from [p, end) into out[], advancing p past them
+    //an incomplete record at <end> is left for the next call unless <final> is set
+    virtual uint parse(const char*& p, const char* end, Access* out, uint max, bool final) = 0;
+};
+
+//"<hex address> <r|w>" per line, the original cacheman format, optionally followed by
+//the hex address of the instruction making the access
+class TextTraceParser : public TraceParser
+{
+public:
+    uint parse(const char*& p, const char* end, Access* out, uint max, bool final);
+};
+
+//C_TRAC_BIN_MAGIC header, then C_TRAC_BIN_RECORD-byte records:
+//  little-endian 64-bit address, 1 flag byte (bit 0: write)
+class BinaryTraceParser : public TraceParser
+{
+private:
+    bool headerSeen = false;
+public:
+    uint parse(const char*& p, const char* end, Access* out, uint max, bool final);
+};
+
+//"I|L|S|M <hex address>,<size>" per line; M is a load then a store, "==" lines are skipped
+class LackeyTraceParser : public TraceParser
+{
+public:
+    uint parse(const char*& p, const char* end, Access* out, uint max, bool final);
+};
+
+//"<label> <hex address> [<hex size>]" per line; labels 0 read, 1 write, 2 fetch,
+//others (escapes) ignored
+class DinTraceParser : public TraceParser
+{
+public:
+    uint parse(const char*& p, const char* end, Access* out, uint max, bool final);
+};
+
+//C_TRAC_CHAMPSIM_RECORD-byte little-endian input_instr records: a fetch of ip, then
+//reads of the non-zero source_memory and writes of the non-zero destination_memory
+class ChampSimTraceParser : public TraceParser
+{
+public:
+    uint parse(const char*& p, const char* end, Access* out, uint max, bool final);
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : TraceReader
+*    Application        : Decodes a trace on its own thread into a pool of batch buffers, handed
+*                         to the simulation thread over SPSC queues and recycled after use
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+typedef struct Batchst
+{
+    Access*  accesses = NULL;
+    uint     count    = 0;
+}  Batch;
+
+class TraceReader
+{
+private:
+    TraceSource  source;
+    TraceParser* parser = NULL;
+
+    Batch pool[C_BATCH_POOL];
+    SpscQueue<Batch*, C_BATCH_POOL> freeBatches;   //simulation -> reader
+    SpscQueue<Batch*, C_BATCH_POOL * 2> fullBatches;  //reader -> simulation, NULL ends
+
+    std::thread worker;
+    std::atomic<bool> stopping{false};  //set by the destructor, the reader gives up waiting
+
+    //run on the reader thread when it starts, and before it marks the end of the trace
+    std::function<void()> onStart;
+    std::function<void()> onEnd;
+
+    //reader thread body
+    void run();
+    //fills one batch from the source, returns false once input is exhausted
+    bool fill(Batch* batch);
+public:
+    ~TraceReader();
+
+    //opens the trace and starts the reader thread
+    //format: C_TRAC_AUTO picks binary if the magic is present, else text
+    //instruction fetches are dropped unless <keepFetches>
+    bool open(const std::string& filename, int format, bool keepFetches);
+
+    //next decoded batch, NULL at end of trace; blocks while the reader is behind
+    Batch* acquire();
+    //hands a consumed batch back for reuse
+    void release(Batch* batch);
+
+    //hooks run on the reader thread, e.g. to count its host events; <end> is done before
+    //acquire() returns NULL, so what it leaves is readable then; call before open()
+    void setThreadHooks(std::function<void()> start, std::function<void()> end)
+    {
+        onStart = start;
+        onEnd = end;
+    }
+
+    //bytes decoded so far (readable from any thread) and in all, see TraceSource
+    const std::atomic<unsigned long long>* getPosition()  {return source.getPosition();}
+    unsigned long long getSize()  {return source.getSize();}
+
+    //the trace could not be read to its end (message already on stderr), valid once acquire()
+    //has returned NULL
+    bool hasFailed()  {return source.hasFailed() || parser->hasFailed();}
+
+    //instructions in the trace, valid once acquire() has returned NULL
+    unsigned long long getInstructions()  {return parser->getInstructions();}
+};
+
+/*-------------------------------------------------------------------------------------------------
+*    Class Name         : TraceGenerator
+*    Application        : Synthesizes a trace of one-word accesses in place of a trace file:
+*                         the same seed and config give the same stream on every platform
+*                         (integer xorshift, zipf weights from basic arithmetic only, no libm)
+*    Inheritances       : Nil
+-------------------------------------------------------------------------------------------------*/
+typedef struct GeneratorConfigst
+{
+    int     pattern = C_GEN_SEQUENTIAL;
+    unsigned long long length = 1000000;   //accesses
+    unsigned long long seed   = 1;
+    addr_t  base      = 0;          //lowest address
+    addr_t  footprint = 1 << 20;    //words spanned
+    uint    stride    = 16;         //words between strided accesses, zipf items and chase nodes
+    uint    writes    = 30;         //percent of accesses that write
+    double  skew      = 0.99;       //zipf exponent
+}  GeneratorConfig;
+
+class TraceGenerator
+{
+private:
+    GeneratorConfig config;
+    unsigned long long state;       //xorshift64* state
+    unsigned long long produced = 0;
+
+    addr_t slots;                   //footprint / stride: zipf items and chase nodes
+    unsigned long long position = 0;    //sequential and strided cursors share it
+    std::vector<double> cdf;        //zipf: cumulative item weights
+    std::vector<uint> next;         //chase: node -> following node
+    uint node = 0;
+
+    std::vector<Access> buffer;
+    Batch batch;
+
+    unsigned long long random();
+    addr_t nextAddress(int pattern);
+public:
+    TraceGenerator(const GeneratorConfig& config);
+
+    //fills up to <max> accesses, 0 once <length> are out
+    uint generate(Access* out, uint max);
+
+    //same interface as TraceReader: next batch, NULL at the end
+    Batch* acquire();
+    void release(Batch*)  {}
+
+    //writes the whole stream as a C_TRAC_BIN trace
+    bool writeBinary(const std::string& path);
+};
+
+#endif